@@ -33,6 +33,8 @@
  */
 
 #include "Adafruit_Thermal.h"
+#include "Adafruit_ThermalPool.h"
+#include "Adafruit_ThermalCodePages.h"
 
 // Though most of these printers are factory configured for 19200 baud
 // operation, a few rare specimens instead work at 9600.  If so, change
@@ -47,12 +49,17 @@
 #define ASCII_LF '\n'  //!< Line feed
 #define ASCII_FF '\f'  //!< Form feed
 #define ASCII_CR '\r'  //!< Carriage return
+#define ASCII_DLE 16   //!< Data link escape
 #define ASCII_DC2 18   //!< Device control 2
 #define ASCII_ESC 27   //!< Escape
 #define ASCII_FS 28    //!< Field separator
 #define ASCII_GS 29    //!< Group separator
 #define FIN_CMD 12      //!< Instruction Terminator (Found commands weren't executing without a terminator)
 
+#define LINE_DOTS 384 //!< Printable width of a line, in dots
+#define TAB_DOTS 48   //!< Tab stop spacing set by reset() (4 font A columns)
+#define TAB_LAST 336  //!< Last tab stop set by reset()
+
 // Because there's no flow control between the printer and Arduino,
 // special care must be taken to avoid overrunning the printer's buffer.
 // Serial output is throttled based on serial speed as well as an estimate
@@ -71,31 +78,263 @@
  */
 #define BYTE_TIME (((11L * 1000000L) + (BAUDRATE / 2)) / BAUDRATE)
 
+// Status replies to DLE EOT take a few milliseconds; these bound the waits
+// for printers that never answer (e.g. with no RX line wired).
+#define STATUS_TIMEOUT 1000L  //!< getStatus() reply wait, in milliseconds
+#define WAKE_TIMEOUT 50000L   //!< Longest wake() pause, in microseconds
+#define PROBE_INTERVAL 10000L //!< Microseconds between wake() probes
+#define ASB_BITS 0x0E //!< GS a bits for online, error and paper reports
+
+// Asynchronous job queue records (see poll())
+#define JOB_DATA_MAX 127 //!< Largest data record
+#define JOB_DELAY 0x80   //!< Record header: timeoutSet() value follows
+#define JOB_END 0x81     //!< Record header: end of job marker
+#define JOB_CREDIT 0x82  //!< Record header: waitCredit() count follows
+#define JOB_EXTEND 0x83  //!< Record header: timeoutExtend() value follows
+#define JOB_FIELD 0x84   //!< Record header: composeField() index follows
+#define JOB_STATUS 0x85  //!< Record header: requestStatus() page follows
+#define JOB_LAYOUT 0x86  //!< Record header: line width and height follow
+#define JOB_NONE 0xFFFF  //!< No record index
+
+#ifdef ARDUINO_ARCH_ESP32
+#define JOB_FENCE() __sync_synchronize() //!< Orders queue accesses (cores)
+#else
+#define JOB_FENCE() //!< Single thread of control; nothing to order
+#endif
+
+// Optional instrumentation (see ThermalStats)
+#ifdef THERMAL_STATS
+#define STATS_KIND(k) (statsKind = (k))
+#define STATS_BYTES(n)                                                         \
+  (stats.bytes += (n), stats.kindBytes[statsKind] += (n))
+#define STATS_WAIT_BEGIN() unsigned long waitStart = micros()
+#define STATS_WAIT_END() statsWait(waitStart)
+#else
+#define STATS_KIND(k)
+#define STATS_BYTES(n)
+#define STATS_WAIT_BEGIN()
+#define STATS_WAIT_END()
+#endif
+
+// Fixed command sequences.  A ThermalCommand's bytes are its template
+// arguments, laid down at compile time as a single array in flash, so a
+// sequence with no runtime parameters costs one table and a loop instead
+// of a chain of writeBytes() calls.  ThermalJoin appends one sequence to
+// another to build a longer blob.
+template <uint8_t... B> struct ThermalCommand {
+  static const uint8_t bytes[sizeof...(B)]; //!< The command, in PROGMEM
+};
+template <uint8_t... B>
+const uint8_t ThermalCommand<B...>::bytes[sizeof...(B)] PROGMEM = {B...};
+
+template <class A, class B> struct ThermalJoin;
+template <uint8_t... A, uint8_t... B>
+struct ThermalJoin<ThermalCommand<A...>, ThermalCommand<B...> > {
+  typedef ThermalCommand<A..., B...> type; //!< A followed by B
+};
+
+typedef ThermalCommand<ASCII_ESC, '@'> CmdInit; // Initialize printer
+typedef ThermalJoin<CmdInit, // ...then set tab stops every 4 columns
+                    ThermalCommand<ASCII_ESC, 'D', 4, 8, 12, 16, 20, 24, 28,
+                                   0> >::type CmdInitTabs;
+typedef ThermalCommand<ASCII_ESC, '8', 0, 0> CmdSleepOff;
+typedef ThermalCommand<ASCII_GS, 'a', (1 << 5)> CmdDtrOn; // DTR flow control
+
 // Constructor
 Adafruit_Thermal::Adafruit_Thermal(Stream *s, uint8_t dtr)
     : stream(s), dtrPin(dtr) {
   dtrEnabled = false;
+  printMode = 0;
+  autoLineHeight = true;
+  styleDeferred = styleDirty = false;
+  userChars = wordWrap = densityTiming = false;
+  heatDots = 96;
+  lineInk = 0;
+  wordLen = 0;
+  wordDots = 0;
+  memset(userWidths, 0, sizeof userWidths);
+  memset(utf8Chars, 0, sizeof utf8Chars);
+  invalidateState();
+  cmdLen = 0;
+  batchDepth = 0;
+  jobBuf = NULL;
+  jobTime = jobTimeDone = 0;
+  pool = NULL;
+  txBuffered = false;
+#ifdef ARDUINO_ARCH_ESP32
+  jobTask = NULL;
+  taskRun = false;
+#endif
+  composing = false;
+  jobCallback = NULL;
+  statusCallback = NULL;
+  statusWanted = statusKnown = statusBits = 0;
+  statusQueued = false;
+  asbEnabled = jobPaused = false;
+  asbCount = 0;
+  statusInterval = 0;
+  statusAsked = 0;
+  learnRows = 0;
+  bufferSize = 256;
+  bufferBytes = 0;
+  memset(&stats, 0, sizeof stats);
+  statsKind = STATS_COMMAND;
 }
 
 // This method sets the estimated completion time for a just-issued task.
+// Any staged command bytes are part of that task, so they go out first.
+// In asynchronous mode the estimate is queued behind the task's bytes
+// and applied by poll() once they have actually been sent.
 void Adafruit_Thermal::timeoutSet(unsigned long x) {
-  if (!dtrEnabled)
-    resumeTime = micros() + x;
+  commitBytes();
+  if (!dtrEnabled) {
+    if (jobBuf) {
+      queueDelay(x);
+    } else {
+      bufferSettle(); // Settle the buffer estimate against the old timeout
+      resumeTime = micros() + x;
+    }
+  }
 }
 
 // This function waits (if necessary) for the prior task to complete.
+// In asynchronous mode it returns at once; poll() does the waiting.
 void Adafruit_Thermal::timeoutWait() {
-  if (dtrEnabled) {
-    while (digitalRead(dtrPin) == HIGH) {
+  commitBytes();
+  if (jobBuf) {
+    jobOpen = jobCredit = JOB_NONE; // Next data waits for an idle printer
+    return;
+  }
+  if (learnRows)
+    learnTimes();
+  if (!printerReady()) {
+    STATS_WAIT_BEGIN();
+    do {
       yield();
-    };
-  } else {
-    while ((long)(micros() - resumeTime) < 0L) {
+    } while (!printerReady());
+    STATS_WAIT_END();
+  }
+}
+
+// Printer input buffer model.  Rather than waiting for the printer to go
+// idle before every write, text and bitmap rows are sent as soon as the
+// printer's buffer has room for them.  Every byte sent is added to an
+// estimate of buffer occupancy, and those bytes are assumed to drain
+// evenly until the current timeout expires.  waitCredit() holds off until
+// the estimate says the next write fits, and timeoutExtend() adds a
+// write's print time on the end of whatever is already in progress.
+
+// Sets the size of the printer's input buffer, which varies by model.
+void Adafruit_Thermal::setBufferSize(uint16_t size) {
+  if (size < 48)
+    size = 48;
+  bufferSize = size;
+}
+
+// Estimated bytes still in the printer's input buffer, rounded up.  This
+// doesn't update bufferBytes: waitCredit() asks in a tight loop, and
+// rescaling the stored count on every call would truncate it away a byte
+// at a time.
+uint16_t Adafruit_Thermal::bufferLevel() {
+  long left = (long)(resumeTime - micros());
+  if (left <= 0)
+    return 0;
+  unsigned long span = resumeTime - bufferStamp;
+  if (span <= (unsigned long)left)
+    return bufferBytes;
+  while (span > 0xFFFF) { // Keep the product within 32 bits
+    span >>= 1;
+    left >>= 1;
+  }
+  return ((uint32_t)bufferBytes * left + span - 1) / span;
+}
+
+// Brings bufferBytes up to date, before a change to the timeout it
+// drains against.
+void Adafruit_Thermal::bufferSettle() {
+  unsigned long now = micros();
+  bufferBytes = bufferLevel();
+  bufferStamp = now;
+}
+
+// Counts n bytes just sent toward the buffer estimate.
+void Adafruit_Thermal::bufferAdd(size_t n) {
+  bufferSettle();
+  uint32_t b = (uint32_t)bufferBytes + n;
+  bufferBytes = (b > 0xFFFF) ? 0xFFFF : b;
+}
+
+// True if n more bytes fit in the printer's buffer now.
+bool Adafruit_Thermal::creditReady(uint16_t n) {
+  if (dtrEnabled)
+    return printerReady();
+  return (uint32_t)bufferLevel() + n <= bufferSize;
+}
+
+// Waits (if necessary) until n more bytes fit in the printer's buffer.
+void Adafruit_Thermal::waitCredit(uint16_t n) {
+  commitBytes();
+  if (jobBuf) {
+    queueCredit(n);
+    return;
+  }
+  if (!creditReady(n)) {
+    STATS_WAIT_BEGIN();
+    do {
       yield();
-    }; // (syntax is rollover-proof)
+    } while (!creditReady(n));
+    STATS_WAIT_END();
   }
 }
 
+// Adds x microseconds of work after everything already in progress.
+void Adafruit_Thermal::timeoutExtend(unsigned long x) {
+  commitBytes();
+  if (dtrEnabled)
+    return;
+  if (jobBuf) {
+    queueExtend(x);
+    return;
+  }
+  bufferSettle();
+  unsigned long now = micros();
+  if ((long)(resumeTime - now) < 0L)
+    resumeTime = now;
+  resumeTime += x;
+}
+
+// True once the printer is ready for more data: the DTR line is low or
+// the current timeout has expired (rollover-proof).
+bool Adafruit_Thermal::printerReady() {
+  if (dtrEnabled)
+    return digitalRead(dtrPin) == LOW;
+  return (long)(micros() - resumeTime) >= 0L;
+}
+
+#ifdef THERMAL_STATS
+// Records a wait that started at 'start' and has just ended.
+void Adafruit_Thermal::statsWait(unsigned long start) {
+  unsigned long t = micros() - start;
+  stats.waitMicros += t;
+  if (t > stats.maxWait)
+    stats.maxWait = t;
+  stats.waits++;
+  stats.waitHistogram[(t < 1000L)     ? 0
+                      : (t < 10000L)  ? 1
+                      : (t < 100000L) ? 2
+                                      : 3]++;
+  if (dtrEnabled)
+    stats.dtrStalls++;
+}
+#endif
+
+ThermalStats Adafruit_Thermal::getStats(bool reset) {
+  ThermalStats s = stats;
+  if (reset)
+    memset(&stats, 0, sizeof stats);
+  return s;
+}
+
 // Printer performance may vary based on the power supply voltage,
 // thickness of paper, phase of the moon and other seemingly random
 // variables.  This method sets the times (in microseconds) for the
@@ -112,47 +351,238 @@ void Adafruit_Thermal::setTimes(unsigned long p, unsigned long f) {
   dotFeedTime = f;
 }
 
-// The next four helper methods are used when issuing configuration
+unsigned long Adafruit_Thermal::getDotPrintTime() { return dotPrintTime; }
+
+unsigned long Adafruit_Thermal::getDotFeedTime() { return dotFeedTime; }
+
+// Dot-density timing.  The head can only fire so many dots at once (the
+// max heating dots of setHeatConfig()), so a dark row is printed in
+// several heating passes while a sparse one needs just one.  With
+// densityTimingOn(), the print time is taken to be that of a row needing
+// every pass, a blank row costs the feed time, and rows in between are
+// interpolated by their number of passes.  Receipts that are mostly white
+// space finish far sooner than the flat model predicts, without ever
+// budgeting less than the flat model for a full row.
+
+void Adafruit_Thermal::densityTimingOn() { densityTiming = true; }
+
+void Adafruit_Thermal::densityTimingOff() { densityTiming = false; }
+
+// Heating passes needed to print a row with 'dots' black dots.
+uint8_t Adafruit_Thermal::heatPasses(uint16_t dots) {
+  return (dots + heatDots - 1) / heatDots;
+}
+
+// Time to print one dot row with 'dots' black dots.
+unsigned long Adafruit_Thermal::rowPrintTime(uint16_t dots) {
+  uint8_t full = heatPasses(LINE_DOTS), passes;
+  if (!densityTiming || (dotPrintTime <= dotFeedTime))
+    return dotPrintTime;
+  passes = heatPasses(dots);
+  if (passes >= full)
+    return dotPrintTime;
+  return dotFeedTime + (dotPrintTime - dotFeedTime) * passes / full;
+}
+
+// With the DTR handshake enabled, the printer itself reports when it is
+// busy, so the print and feed times can be measured instead of guessed.
+// calibrate() feeds a little paper and prints a short, narrow bar (narrow
+// so the serial link is never the bottleneck), timing each from the
+// moment it was sent until DTR drops, and loads the results with
+// setTimes().  After that, every feedRows() and every bitmap chunk that
+// isn't limited by the serial link is timed the same way and blended
+// into the current estimates, so they track heat settings and supply
+// voltage.  The learned times stay useful if DTR is later unavailable,
+// e.g. saved with saveTimes() for units wired without the DTR pin.
+
+#define CAL_FEED_ROWS 96  //!< Dot rows fed when calibrating the feed time
+#define CAL_PRINT_ROWS 48 //!< Dot rows printed when calibrating print time
+#define CAL_BAR_WIDTH 32  //!< Width in pixels of the calibration bar
+
+static const uint8_t calibrationRow[CAL_BAR_WIDTH / 8] = {0xFF, 0xFF, 0xFF,
+                                                          0xFF};
+
+static const uint8_t *getCalibrationRow(void *, int, uint8_t *, uint8_t) {
+  return calibrationRow;
+}
+
+// Waits out the printer's DTR busy period and returns how long after
+// 'start' it ended, or 0 if DTR wasn't seen high within 'window' usec.
+unsigned long Adafruit_Thermal::busyTime(unsigned long start,
+                                         unsigned long window) {
+  unsigned long t = micros();
+  while (digitalRead(dtrPin) == LOW) {
+    if ((micros() - t) >= window)
+      return 0;
+    yield();
+  }
+  while (digitalRead(dtrPin) == HIGH) {
+    yield();
+  }
+  return micros() - start;
+}
+
+// Folds the busy period started by the last feed or bitmap chunk into
+// the running estimate.  Only called from timeoutWait() with DTR on.
+void Adafruit_Thermal::learnTimes() {
+  unsigned long t = busyTime(learnStart, 0);
+  if (t) {
+    t /= learnRows;
+    if (learnFeed) {
+      dotFeedTime = (dotFeedTime * 3 + t) / 4;
+    } else if (!densityTiming) {
+      dotPrintTime = (dotPrintTime * 3 + t) / 4;
+    } else if (learnPasses && (t > dotFeedTime)) { // Scale to a full row
+      t = dotFeedTime + (t - dotFeedTime) * heatPasses(LINE_DOTS) *
+                            learnRows / learnPasses;
+      dotPrintTime = (dotPrintTime * 3 + t) / 4;
+    }
+  }
+  learnRows = 0;
+}
+
+bool Adafruit_Thermal::calibrate() {
+  unsigned long feed, print;
+
+  if (!dtrEnabled)
+    return false;
+  drain();
+  timeoutWait();
+
+  writeBytes(ASCII_ESC, 'J', CAL_FEED_ROWS);
+  feed = busyTime(micros(), 20000L);
+  timeoutWait();
+
+  printBitmapRows(CAL_BAR_WIDTH, CAL_PRINT_ROWS, getCalibrationRow, NULL,
+                  false);
+  learnRows = 0; // Measured directly instead
+  print = busyTime(learnStart, 20000L);
+  lineDots = lineHeight = 0;
+
+  if (!feed || !print)
+    return false;
+  feed /= CAL_FEED_ROWS;
+  print /= CAL_PRINT_ROWS;
+  if (densityTiming && (print > feed)) // The bar takes one heating pass
+    print = feed + (print - feed) * heatPasses(LINE_DOTS);
+  setTimes(print, feed);
+  return true;
+}
+
+#ifdef THERMAL_HAS_EEPROM
+#define CAL_MAGIC 0x7454 //!< Marks valid saved print/feed times
+
+//! Print and feed times as laid out in EEPROM
+struct SavedTimes {
+  uint16_t magic;         //!< CAL_MAGIC if valid
+  unsigned long dotPrint; //!< Saved dotPrintTime
+  unsigned long dotFeed;  //!< Saved dotFeedTime
+};
+
+void Adafruit_Thermal::saveTimes(int addr) {
+  SavedTimes t = {CAL_MAGIC, dotPrintTime, dotFeedTime};
+  EEPROM.put(addr, t);
+#if defined(ESP32) || defined(ESP8266)
+  EEPROM.commit();
+#endif
+}
+
+bool Adafruit_Thermal::loadTimes(int addr) {
+  SavedTimes t;
+  EEPROM.get(addr, t);
+  if ((t.magic != CAL_MAGIC) || !t.dotPrint || !t.dotFeed)
+    return false;
+  setTimes(t.dotPrint, t.dotFeed);
+  return true;
+}
+#endif
+
+// The next few helper methods are used when issuing configuration
 // commands, printing bitmaps or barcodes, etc.  Not when printing text.
+// Command bytes are staged in cmdBuf rather than sent one at a time;
+// consecutive commands then go out in a single block write that pays
+// for one timeoutWait() and one timeoutSet().  Outside of a batch the
+// staged bytes are committed as soon as each command is complete, so
+// single calls behave exactly as before.
+
+// Append one byte to the command staging buffer, committing first if full.
+void Adafruit_Thermal::queueByte(uint8_t b) {
+  flushWord(); // Text written before this command goes first
+  if (cmdLen >= THERMAL_CMD_BUFFER_SIZE)
+    commitBytes();
+  cmdBuf[cmdLen++] = b;
+}
+
+// Send any staged command bytes in one write, paced as a single task.
+void Adafruit_Thermal::commitBytes() {
+  if (cmdLen) {
+    uint8_t n = cmdLen;
+    cmdLen = 0; // Clear first; timeoutWait() and timeoutSet() commit too
+    timeoutWait();
+    sendBytes(cmdBuf, n);
+    timeoutSet(n * BYTE_TIME);
+  }
+  flushWord();
+}
+
+// Hold back command bytes until the matching endBatch().  Batches nest,
+// so library methods can use them internally without disturbing a batch
+// opened by the caller.
+void Adafruit_Thermal::beginBatch() { batchDepth++; }
+
+// Close a batch; the outermost endBatch() is the commit point.
+void Adafruit_Thermal::endBatch() {
+  if (batchDepth && !--batchDepth)
+    commitBytes();
+}
 
 void Adafruit_Thermal::writeBytes(uint8_t a) {
-  timeoutWait();
-  stream->write(a);
-  timeoutSet(BYTE_TIME);
+  queueByte(a);
+  if (!batchDepth)
+    commitBytes();
 }
 
 void Adafruit_Thermal::writeBytes(uint8_t a, uint8_t b) {
-  timeoutWait();
-  stream->write(a);
-  stream->write(b);
-  timeoutSet(2 * BYTE_TIME);
+  queueByte(a);
+  queueByte(b);
+  if (!batchDepth)
+    commitBytes();
 }
 
 void Adafruit_Thermal::writeBytes(uint8_t a, uint8_t b, uint8_t c) {
-  timeoutWait();
-  stream->write(a);
-  stream->write(b);
-  stream->write(c);
-  timeoutSet(3 * BYTE_TIME);
+  queueByte(a);
+  queueByte(b);
+  queueByte(c);
+  if (!batchDepth)
+    commitBytes();
 }
 
 void Adafruit_Thermal::writeBytes(uint8_t a, uint8_t b, uint8_t c, uint8_t d) {
-  timeoutWait();
-  stream->write(a);
-  stream->write(b);
-  stream->write(c);
-  stream->write(d);
-  timeoutSet(4 * BYTE_TIME);
+  queueByte(a);
+  queueByte(b);
+  queueByte(c);
+  queueByte(d);
+  if (!batchDepth)
+    commitBytes();
 }
 
-void Adafruit_Thermal::writeBytes(uint8_t a, uint8_t b, uint8_t c, uint8_t d, uint8_t e) {
-  timeoutWait();
-  stream->write(a);
-  stream->write(b);
-  stream->write(c);
-  stream->write(d);
-  stream->write(e);
-  timeoutSet(5 * BYTE_TIME);
+void Adafruit_Thermal::writeBytes(uint8_t a, uint8_t b, uint8_t c, uint8_t d,
+                                  uint8_t e) {
+  queueByte(a);
+  queueByte(b);
+  queueByte(c);
+  queueByte(d);
+  queueByte(e);
+  if (!batchDepth)
+    commitBytes();
+}
+
+// Stages a fixed sequence from flash, committing it like writeBytes().
+void Adafruit_Thermal::writeCommand(const uint8_t *cmd, uint8_t n) {
+  for (uint8_t i = 0; i < n; i++)
+    queueByte(pgm_read_byte(&cmd[i]));
+  if (!batchDepth)
+    commitBytes();
 }
 
 void Adafruit_Thermal::writeCmdBytes(uint8_t a, uint8_t b, uint8_t c, bool d) {
@@ -160,6 +590,8 @@ void Adafruit_Thermal::writeCmdBytes(uint8_t a, uint8_t b, uint8_t c, bool d) {
   //All other writebyte commands will wait for the dtrPin to be LOW before continuing. This will never happen while the printer lid is open and there is no RTS pin used.
   //This function is used only for requesting the status of the printer while the lid is open. 
   //Should NEVER be used for any commands that cause the printer to print characters.
+  commitBytes(); // Keep staged commands ahead of this one
+  drain();       // ...and anything still in the job queue
   if(!d) timeoutWait();
   stream->write(a);
   stream->write(b);
@@ -167,26 +599,614 @@ void Adafruit_Thermal::writeCmdBytes(uint8_t a, uint8_t b, uint8_t c, bool d) {
   timeoutSet(3 * BYTE_TIME);
 }
 
+// Sends n bytes as one paced block, or as a few if it's bigger than the
+// printer's buffer.
+void Adafruit_Thermal::sendBlock(const uint8_t *buf, size_t n) {
+  while (n) {
+    uint16_t k = (n > bufferSize) ? bufferSize : n;
+    waitCredit(k);
+    sendBytes(buf, k);
+    timeoutExtend(k * BYTE_TIME);
+    buf += k;
+    n -= k;
+  }
+}
+
+// Every byte bound for the printer passes through here.  In blocking mode
+// it goes straight to the stream; in asynchronous mode it is appended to
+// the job queue and sent later by poll().
+void Adafruit_Thermal::sendBytes(const uint8_t *buf, size_t n) {
+  STATS_BYTES(n);
+  if (jobBuf) {
+    queueData(buf, n);
+  } else {
+    stream->write(buf, n);
+    bufferAdd(n);
+  }
+}
+
+// === Asynchronous job queue ===
+// The queue is a ring of records in a caller-supplied buffer.  A header
+// byte of 1-127 is a count of data bytes that follow it; JOB_DELAY and
+// JOB_EXTEND are followed by a 32-bit time (as passed to timeoutSet() or
+// timeoutExtend()), JOB_CREDIT by a 16-bit byte count for waitCredit(),
+// and JOB_END marks the end of a job.  A data record waits for an idle
+// printer unless credit records ahead of it cover all of its bytes.  Data
+// records are paced at BYTE_TIME per byte when sent, so a delay no longer
+// than the bytes queued since the last timing record adds nothing and is
+// dropped.  Extend times always count, but are held and summed until the
+// next record is started (or poll() finds the queue empty), so the data
+// and credit records ahead of them can go on growing.  On a stream with
+// a transmit buffer (a HardwareSerial, which reports its free space with
+// availableForWrite()), poll() writes no more than fits in it, leaving
+// the rest of a record queued, so the UART's TX interrupt does the
+// sending and poll() never waits inside the serial driver.  Until a
+// stream first reports some space, it's taken to be unbuffered (that's
+// Print's default) and records are written whole, as before.
+
+void Adafruit_Thermal::beginAsync(uint8_t *buf, uint16_t size) {
+  endAsync();
+  commitBytes();
+  jobOpen = jobDelay = jobCredit = JOB_NONE;
+  jobWr = jobTail = jobPub = jobSince = jobCredited = 0;
+  jobHungry = jobCut = false;
+  jobExtendTime = jobTime = jobTimeDone = 0;
+  jobCount = jobsDone = 0;
+  jobSize = size;
+  if (buf && (size >= 8))
+    jobBuf = buf;
+}
+
+void Adafruit_Thermal::endAsync() {
+  drain();
+#ifdef ARDUINO_ARCH_ESP32
+  if (jobTask) {
+    taskRun = false;
+    while (jobTask) // Cleared by the task as it exits
+      vTaskDelay(1);
+  }
+#endif
+  jobBuf = NULL;
+}
+
+// Blocks until every queued byte has been handed to the stream.
+void Adafruit_Thermal::drain() {
+  if (jobShared()) {
+    if (jobPub != jobWr)
+      jobPublish(false);
+    while (jobTail != jobWr)
+      yield();
+    return;
+  }
+  while (poll()) {
+    if (pool)
+      pool->poll(); // Keep the other printers going meanwhile
+    yield();
+  }
+}
+
+// Sends as much of the job queue as the current time budget allows and
+// returns immediately.  Returns true while queued data remains.
+bool Adafruit_Thermal::poll() {
+#ifdef ARDUINO_ARCH_ESP32
+  if (jobTask && (xTaskGetCurrentTaskHandle() != jobTask))
+    return jobTail != jobWr; // The print task does the sending
+#endif
+  pollStatus();
+  if (!jobBuf || composing)
+    return false;
+  if (asbEnabled && (statusBits & (STATUS_PAPER_OUT | STATUS_COVER_OPEN))) {
+    if (!jobPaused) {
+      jobPaused = true;
+      pauseStart = micros();
+    }
+    return jobTail != jobWr;
+  }
+  if (jobPaused) {
+    // The printer stopped with data in its buffer; what it hadn't
+    // printed when the pause began is still to do
+    unsigned long d = micros() - pauseStart;
+    jobPaused = false;
+    if ((long)(resumeTime - pauseStart) > 0L) {
+      resumeTime += d;
+      bufferStamp += d;
+    }
+  }
+  uint16_t end = jobWr;
+  if (jobShared()) {
+    end = jobPub; // Only published records are finished
+    JOB_FENCE();
+  } else if (jobTail == jobWr) {
+    jobFlushExtend(); // Nothing left for it to wait behind
+  }
+
+  while (jobTail != end) {
+    uint16_t start = jobTail, at = start;
+    uint8_t h = jobBuf[at];
+
+    if ((h == JOB_DELAY) || (h == JOB_EXTEND)) {
+      // Applies as soon as the preceding data is out
+      unsigned long x = 0;
+      for (uint8_t i = 0; i < 4; i++) {
+        at = jobNext(at);
+        x |= (unsigned long)jobBuf[at] << (i * 8);
+      }
+      jobConsume(jobNext(at));
+      if (jobDelay == start)
+        jobDelay = JOB_NONE;
+      jobTimeDone += x;
+      bufferSettle();
+      unsigned long now = micros();
+      if ((h == JOB_DELAY) || ((long)(resumeTime - now) < 0L))
+        resumeTime = now;
+      resumeTime += x;
+      continue;
+    }
+
+    if (h == JOB_CREDIT) {
+      uint16_t n = jobBuf[jobNext(at)];
+      at = jobNext(jobNext(at));
+      n |= jobBuf[at] << 8;
+      at = jobNext(at);
+      if ((at == end) || !creditReady(n))
+        break; // Wait for the data it covers, or for room
+      jobConsume(at);
+      if (jobCredit == start)
+        jobCredit = JOB_NONE;
+      jobCredited = ((uint32_t)jobCredited + n > 0xFFFF) ? 0xFFFF
+                                                         : jobCredited + n;
+      continue;
+    }
+
+    if (h == JOB_STATUS) {
+      at = jobNext(at);
+      jobConsume(jobNext(at));
+      if (statusQueued)
+        sendStatusRequest();
+      continue;
+    }
+
+    if (h == JOB_END) {
+      if (!printerReady())
+        break;
+      jobConsume(jobNext(at));
+      jobsDone++;
+      if (jobCallback)
+        jobCallback(jobsDone, queuedBytes());
+      continue;
+    }
+
+    // Data record; may be split by the end of the ring
+    if ((jobCredited < h) && !printerReady())
+      break;
+    uint8_t n = h;
+    int room = stream->availableForWrite();
+    if (room > 0)
+      txBuffered = true;
+    if (txBuffered && (room < n)) {
+      if (room <= 0)
+        break; // TX buffer full; the UART interrupt is still sending
+      n = room;
+    }
+    if (jobOpen == start)
+      jobOpen = JOB_NONE;
+    at = jobNext(at);
+    uint16_t run = jobSize - at;
+    if (run >= n) {
+      stream->write(&jobBuf[at], n);
+    } else {
+      stream->write(&jobBuf[at], run);
+      stream->write(jobBuf, n - run);
+    }
+    if (n < h) {
+      // The rest stays queued, under a header in the last byte sent
+      at = (at + n - 1) % jobSize;
+      jobBuf[at] = h - n;
+      jobConsume(at);
+    } else {
+      jobConsume((at + h) % jobSize);
+    }
+    jobCredited -= (jobCredited < n) ? jobCredited : n;
+    bufferAdd(n);
+    paceBytes(n);
+  }
+
+  if (jobShared() && (jobTail == end))
+    jobHungry = true; // Ask for whatever has been queued since
+  return jobTail != jobWr;
+}
+
+// Holds off further data until n bytes just sent are on the wire.
+void Adafruit_Thermal::paceBytes(size_t n) {
+  unsigned long paced = micros() + n * BYTE_TIME;
+  if ((long)(paced - resumeTime) > 0L)
+    resumeTime = paced;
+}
+
+// Marks the end of the current job.  Returns the job's number, which is
+// passed to the job callback once the printer has finished with it.
+uint16_t Adafruit_Thermal::endJob() {
+  if (!jobBuf)
+    return 0;
+  commitBytes();
+  jobFlushExtend();
+  jobReserve(1);
+  jobPut(JOB_END);
+  jobOpen = jobDelay = jobCredit = JOB_NONE;
+  if (jobShared())
+    jobPublish(true);
+  return ++jobCount;
+}
+
+void Adafruit_Thermal::setJobCallback(ThermalJobCallback callback) {
+  jobCallback = callback;
+}
+
+// Estimated time until the printer is done with everything sent and
+// queued: what's left of the current timeout plus the delay and extend
+// times still in the queue.  Delays are counted in full even though one
+// may overlap the work before it, so this errs on the long side.
+unsigned long Adafruit_Thermal::pendingTime() {
+  long left = (long)(resumeTime - micros());
+  unsigned long t = (left > 0L) ? left : 0;
+  if (jobBuf && !composing)
+    t += jobTime - jobTimeDone;
+  return t;
+}
+
+// Bytes currently held in the job queue, including record headers.
+uint16_t Adafruit_Thermal::queuedBytes() {
+  if (!jobBuf)
+    return 0;
+  return ((uint32_t)jobWr + jobSize - jobTail) % jobSize;
+}
+
+uint16_t Adafruit_Thermal::jobNext(uint16_t i) {
+  return (++i >= jobSize) ? 0 : i;
+}
+
+void Adafruit_Thermal::jobPut(uint8_t b) {
+  jobBuf[jobWr] = b;
+  jobWr = jobNext(jobWr);
+}
+
+// Waits, servicing the queue, until n more bytes will fit.  A recording
+// can't be drained, so one that's full is marked as overflowed instead
+// (and keeps writing within the ring, as its contents no longer matter).
+void Adafruit_Thermal::jobReserve(uint8_t n) {
+  while ((uint16_t)(jobSize - 1 - queuedBytes()) < n) {
+    if (composing) {
+      composeOverflow = true;
+      return;
+    }
+    if (jobShared()) {
+      jobPublish(false); // Let the print task make room
+      yield();
+    } else if (poll()) {
+      if (pool)
+        pool->poll();
+      yield();
+    }
+  }
+}
+
+void Adafruit_Thermal::queueData(const uint8_t *buf, size_t n) {
+  while (n--) {
+    jobReserve(2); // May send (and close) the open record
+    if ((jobOpen != JOB_NONE) && (jobBuf[jobOpen] < JOB_DATA_MAX)) {
+      jobBuf[jobOpen]++;
+    } else {
+      if (jobOpen != JOB_NONE)
+        jobCredit = JOB_NONE; // Later credits must precede the new record
+      if (jobExtendTime) {
+        jobFlushExtend();
+        jobReserve(2);
+      }
+      jobOpen = jobWr;
+      jobPut(1);
+    }
+    jobPut(*buf++);
+    jobSince++;
+    jobDelay = JOB_NONE;
+  }
+  if (jobHungry)
+    jobPublish(false);
+}
+
+void Adafruit_Thermal::queueDelay(unsigned long x) {
+  jobFlushExtend();
+  if (x <= jobSince * BYTE_TIME) {
+    jobSince = 0; // Covered by the pacing of the data just queued
+    if (jobShared())
+      jobPublish(true);
+    return;
+  }
+  if (jobDelay == JOB_NONE) { // Else overwrite, as timeoutSet() would
+    jobReserve(5);
+    jobDelay = jobWr;
+    jobPut(JOB_DELAY);
+    jobPut(0);
+    jobPut(0);
+    jobPut(0);
+    jobPut(0);
+  }
+  uint16_t at = jobDelay;
+  for (uint8_t i = 0; i < 4; i++) {
+    at = jobNext(at);
+    jobTime -= (unsigned long)jobBuf[at] << (i * 8); // Time it replaces
+    jobBuf[at] = x >> (i * 8);
+  }
+  jobTime += x;
+  jobOpen = jobCredit = JOB_NONE;
+  jobSince = 0;
+  if (jobShared())
+    jobPublish(true);
+}
+
+void Adafruit_Thermal::queueExtend(unsigned long x) {
+  jobExtendTime += x;
+  jobTime += x;
+  jobSince = 0;
+  if (jobShared()) {
+    jobFlushExtend(); // Not held: the task can't see it until it's queued
+    jobPublish(true);
+  }
+}
+
+// Queues the extend time held by queueExtend(), after everything so far.
+void Adafruit_Thermal::jobFlushExtend() {
+  if (!jobExtendTime)
+    return;
+  jobReserve(5);
+  jobPut(JOB_EXTEND);
+  for (uint8_t i = 0; i < 4; i++)
+    jobPut(jobExtendTime >> (i * 8));
+  jobExtendTime = 0;
+  jobOpen = jobDelay = JOB_NONE;
+}
+
+// Consecutive credits for one growing data record (e.g. a line of text)
+// are merged into a single credit record.
+void Adafruit_Thermal::queueCredit(uint16_t n) {
+  if (jobCredit == JOB_NONE) {
+    jobFlushExtend();
+    jobReserve(3);
+    jobCredit = jobWr;
+    jobPut(JOB_CREDIT);
+    jobPut(0);
+    jobPut(0);
+    jobOpen = jobDelay = JOB_NONE;
+  }
+  uint16_t lo = jobNext(jobCredit), hi = jobNext(lo);
+  n += jobBuf[lo] | (jobBuf[hi] << 8);
+  jobBuf[lo] = n;
+  jobBuf[hi] = n >> 8;
+  if (jobHungry)
+    jobPublish(false);
+}
+
+// === Print task ===
+// On ESP32, beginTask() moves poll() onto its own FreeRTOS task, so the
+// job queue has a producer (the printing calls) and a consumer (poll())
+// on different cores.  It stays lock-free by giving each side its own
+// indexes: only the producer moves jobWr and jobPub, only the consumer
+// moves jobTail.  The producer normally keeps growing the newest records
+// in place, so in this mode the consumer stops at jobPub, and records
+// are closed before they're published to it; it never reads a record
+// that can still change, never flushes held extend time, and never
+// touches the stream-side state the producer uses.  The producer
+// publishes at every delay, extend, job end and status request (each
+// of which falls between whole commands), when the queue is full, and
+// when the consumer has caught up and asked for more (jobHungry).
+// Callbacks then run on the print task.
+
+// Hands the records queued so far to the print task.  'whole' is true
+// when they end between commands; until the next such point, the status
+// monitor holds its requests back so they can't land inside one.
+void Adafruit_Thermal::jobPublish(bool whole) {
+  jobOpen = jobDelay = jobCredit = JOB_NONE; // Published means final
+  jobHungry = false;
+  if (!whole)
+    jobCut = true;
+  JOB_FENCE(); // Records are in place before the task can see them
+  jobPub = jobWr;
+  JOB_FENCE();
+  if (whole)
+    jobCut = false;
+}
+
+// Moves jobTail past records poll() has finished reading.
+void Adafruit_Thermal::jobConsume(uint16_t to) {
+  JOB_FENCE(); // Done with them before the producer may reuse the room
+  jobTail = to;
+}
+
+// True if a print task is consuming the job queue.
+bool Adafruit_Thermal::jobShared() {
+#ifdef ARDUINO_ARCH_ESP32
+  return jobTask != NULL;
+#else
+  return false;
+#endif
+}
+
+// True when called from the print task itself.
+bool Adafruit_Thermal::onPrintTask() {
+#ifdef ARDUINO_ARCH_ESP32
+  return jobTask && (xTaskGetCurrentTaskHandle() == jobTask);
+#else
+  return false;
+#endif
+}
+
+#ifdef ARDUINO_ARCH_ESP32
+bool Adafruit_Thermal::beginTask(uint8_t *buf, uint16_t size, uint8_t core) {
+  beginAsync(buf, size);
+  if (!jobBuf)
+    return false;
+  taskRun = true;
+  if (xTaskCreatePinnedToCore(printTask, "thermal", THERMAL_TASK_STACK, this,
+                              THERMAL_TASK_PRIORITY, &jobTask,
+                              core) != pdPASS) {
+    jobTask = NULL;
+    taskRun = false; // Carry on in plain asynchronous mode
+    return false;
+  }
+  return true;
+}
+
+void Adafruit_Thermal::printTask(void *arg) {
+  Adafruit_Thermal *p = (Adafruit_Thermal *)arg;
+  while (p->taskRun) {
+    p->poll();
+    vTaskDelay(1);
+  }
+  p->jobTask = NULL; // endAsync() waits for this
+  vTaskDelete(NULL);
+}
+#endif
+
+// === Composed jobs ===
+// A composed job is a recording of the job queue records (see above)
+// that a run of printing calls produces, made by pointing the queue at
+// the caller's buffer and never sending it.  Replaying one feeds each
+// record back through the normal paths: data is sent in one write per
+// record, and the recorded delay, extend and credit times are applied
+// as they were captured, so none of the original calls (or their state
+// tracking and pacing math) are repeated.  JOB_FIELD records mark
+// placeholders printed from the caller's strings.  Each one, and the end
+// of the recording, is preceded by a JOB_LAYOUT record of the line so
+// far (lineDots, then lineHeight), which replay restores, so a field and
+// the text after the replay wrap where the recording left off.  The
+// printer's state cache is cleared around recording and replay, so a
+// recording always carries every setting it depends on.
+
+void Adafruit_Thermal::beginCompose(uint8_t *buf, uint16_t size) {
+  beginAsync(buf, size);
+  invalidateState();
+  composeOverflow = false;
+  composing = (jobBuf != NULL);
+}
+
+uint16_t Adafruit_Thermal::endCompose() {
+  uint16_t len;
+  if (!composing)
+    return 0;
+  flushStyle(); // A deferred style belongs in the recording
+  commitBytes();
+  jobFlushExtend();
+  composeLayout();
+  len = composeOverflow ? 0 : queuedBytes();
+  composing = false;
+  jobBuf = NULL;
+  invalidateState();
+  return len;
+}
+
+void Adafruit_Thermal::composeField(uint8_t id) {
+  if (!composing)
+    return;
+  flushStyle(); // The field prints in the style set ahead of it
+  commitBytes();
+  jobFlushExtend();
+  composeLayout();
+  jobReserve(2);
+  jobPut(JOB_FIELD);
+  jobPut(id);
+  jobOpen = jobDelay = jobCredit = JOB_NONE;
+}
+
+// Records where the line stands, for printComposed() to restore.
+void Adafruit_Thermal::composeLayout() {
+  jobReserve(4);
+  jobPut(JOB_LAYOUT);
+  jobPut(lineDots & 0xFF);
+  jobPut(lineDots >> 8);
+  jobPut(lineHeight);
+  jobOpen = jobDelay = jobCredit = JOB_NONE;
+}
+
+static uint8_t composedByte(const uint8_t *job, uint16_t i, bool fromProgMem) {
+  return fromProgMem ? pgm_read_byte(&job[i]) : job[i];
+}
+
+void Adafruit_Thermal::printComposed(const uint8_t *job, uint16_t len,
+                                     const char *const *fields,
+                                     uint8_t numFields, bool fromProgMem) {
+  uint8_t chunk[32], h, n, k;
+  uint16_t i = 0, credited = 0;
+
+  flushStyle(); // Not midway, ahead of a field
+  commitBytes();
+  while (i < len) {
+    h = composedByte(job, i++, fromProgMem);
+    if (i + ((h <= JOB_DATA_MAX)                       ? h
+             : ((h == JOB_DELAY) || (h == JOB_EXTEND)) ? 4
+             : (h == JOB_CREDIT)                       ? 2
+             : ((h == JOB_FIELD) || (h == JOB_STATUS)) ? 1
+             : (h == JOB_LAYOUT)                       ? 3
+                                                       : 0) > len)
+      break; // Truncated recording
+    if (h <= JOB_DATA_MAX) {
+      if (credited < h)
+        timeoutWait();
+      credited -= (credited < h) ? credited : h;
+      for (n = h; n; n -= k) {
+        k = (n > sizeof chunk) ? sizeof chunk : n;
+        for (uint8_t j = 0; j < k; j++)
+          chunk[j] = composedByte(job, i++, fromProgMem);
+        sendBytes(chunk, k);
+      }
+      if (!jobBuf)
+        paceBytes(h);
+    } else if ((h == JOB_DELAY) || (h == JOB_EXTEND)) {
+      unsigned long x = 0;
+      for (k = 0; k < 4; k++)
+        x |= (unsigned long)composedByte(job, i++, fromProgMem) << (k * 8);
+      if (h == JOB_DELAY)
+        timeoutSet(x);
+      else
+        timeoutExtend(x);
+    } else if (h == JOB_CREDIT) {
+      uint16_t c = composedByte(job, i++, fromProgMem);
+      c |= composedByte(job, i++, fromProgMem) << 8;
+      waitCredit(c);
+      credited = ((uint32_t)credited + c > 0xFFFF) ? 0xFFFF : credited + c;
+    } else if (h == JOB_FIELD) {
+      k = composedByte(job, i++, fromProgMem);
+      if ((k < numFields) && fields && fields[k])
+        print(fields[k]);
+      flushWord(); // All of the field goes ahead of the data after it
+      credited = 0;
+    } else if (h == JOB_STATUS) {
+      requestStatus(composedByte(job, i++, fromProgMem));
+    } else if (h == JOB_LAYOUT) {
+      lineDots = composedByte(job, i++, fromProgMem);
+      lineDots |= composedByte(job, i++, fromProgMem) << 8;
+      lineHeight = composedByte(job, i++, fromProgMem);
+      lineInk = 0; // Its ink was paced when it was recorded
+    } // JOB_END: nothing to do
+  }
+  invalidateState();
+}
+
 // The underlying method for all high-level printing (e.g. println()).
 // The inherited Print class handles the rest!
 size_t Adafruit_Thermal::write(uint8_t c) {
 
   if (c != 13) { // Strip carriage returns
-    timeoutWait();
-    stream->write(c);
-    unsigned long d = BYTE_TIME;
-    if ((c == '\n') || (column == maxColumn)) { // If newline or wrap
-      d += (prevByte == '\n') ? ((charHeight + lineSpacing) * dotFeedTime)
-                              : // Feed line
-               ((charHeight * dotPrintTime) +
-                (lineSpacing * dotFeedTime)); // Text line
-      column = 0;
-      c = '\n'; // Treat wrap as newline on next pass
-    } else {
-      column++;
+    flushStyle();
+    if (wordWrap) {
+      if ((c > ' ') && (wordLen < THERMAL_WORD_MAX)) {
+        wordBuf[wordLen++] = c;
+        wordDots += glyphWidth(c);
+        return 1;
+      }
+      flushWord();
+      if ((c == ' ') && (lineDots + glyphWidth(c) > LINE_DOTS))
+        c = '\n'; // Break the line here instead of printing the space
     }
-    timeoutSet(d);
-    prevByte = c;
+    putChar(c);
   }
 
   return 1;
@@ -202,14 +1222,18 @@ void Adafruit_Thermal::begin(uint16_t version) {
   timeoutSet(500000L);
 
   wake();
-  reset();
 
+  // Setup goes out as a single block write
+  beginBatch();
+  reset();
   setHeatConfig();
+  if (dtrPin < 255)
+    writeCommand<CmdDtrOn>();
+  endBatch();
 
   // Enable DTR pin if requested
   if (dtrPin < 255) {
     pinMode(dtrPin, INPUT_PULLUP);
-    writeBytes(ASCII_GS, 'a', (1 << 5));
     dtrEnabled = true;
   }
 
@@ -220,24 +1244,36 @@ void Adafruit_Thermal::begin(uint16_t version) {
 
 // Reset printer to default state.
 void Adafruit_Thermal::reset() {
-  writeBytes(ASCII_ESC, '@'); // Init command
-  prevByte = '\n';            // Treat as if prior line is blank
-  column = 0;
-  maxColumn = 32;
+  beginBatch();
+  // Init command, and on recent printers configure tab stops
+  if (firmware >= 264)
+    writeCommand<CmdInitTabs>();
+  else
+    writeCommand<CmdInit>();
+  invalidateState();          // Printer's settings are back to its defaults
+  lineDots = 0;               // Treat as if prior line is blank
+  lineHeight = 0;
+  charSpacing = 0;
+  userChars = false;
+  memset(userWidths, 0, sizeof userWidths);
+  printMode = 0;
+  fontData = 0;
+  styleDirty = false;
+  justification = 0;
+  charWidth = 12;
   charHeight = 24;
   lineSpacing = 6;
   barcodeHeight = 50;
-
-  if (firmware >= 264) {
-    // Configure tab stops on recent printers
-    writeBytes(ASCII_ESC, 'D'); // Set tab stops...
-    writeBytes(4, 8, 12, 16);   // ...every 4 columns,
-    writeBytes(20, 24, 28, 0);  // 0 marks end-of-list.
-  }
+  barcodeWidth = 3;
+  barcodeLabel = BARCODE_LABEL_BELOW;
+  if (dtrEnabled || asbEnabled)
+    writeAsbMode(); // ESC @ turns GS a settings off too
+  endBatch();
 }
 
 // Reset text formatting parameters.
 void Adafruit_Thermal::setDefault() {
+  beginBatch();
   online();
   justify('L');
   inverseOff();
@@ -247,11 +1283,37 @@ void Adafruit_Thermal::setDefault() {
   underlineOff();
   autoLineHeight = true;
   setBarcodeHeight(50);
+  setBarcodeWidth(3);
+  setBarcodeLabel(BARCODE_LABEL_BELOW);
   fontData = 0;
   setSize('s');
   setCharset();
   setCodePage();
   cancelKanjiMode();
+  endBatch();
+}
+
+// Printer state cache.  Style commands are often repeated (setDefault()
+// at the top of every receipt, setSize() per line), and each usually
+// leaves the printer as it was.  The last value sent for each setting is
+// kept in shadow[], and a command is skipped if it would send the same
+// value again.  Anything that may have changed the printer's settings
+// behind our back (ESC @, a power cycle, raw bytes) must invalidate it.
+void Adafruit_Thermal::invalidateState() {
+  shadowValid = 0;
+#if THERMAL_GLYPH_CACHE
+  memset(glyphTags, 0, sizeof glyphTags);
+#endif
+}
+
+// True (and records value) if setting 'slot' needs to be sent.
+bool Adafruit_Thermal::stateChanged(uint8_t slot, uint8_t value) {
+  uint32_t bit = 1UL << slot;
+  if ((shadowValid & bit) && (shadow[slot] == value))
+    return false;
+  shadow[slot] = value;
+  shadowValid |= bit;
+  return true;
 }
 
 void Adafruit_Thermal::cancelKanjiMode() {
@@ -259,7 +1321,8 @@ void Adafruit_Thermal::cancelKanjiMode() {
   //This ESC/POS command disables Kanji character mode
   //ESC/POS Command Documentation https://download4.epson.biz/sec_pubs/pos/reference_en/escpos/fs_period.html
   //Firmware version supplied: S1.06 2023 10-31HcDL (I''ve not found a method to update the firmware that matches this model)
-  writeBytes(ASCII_FS, '.');
+  if (stateChanged(SHADOW_KANJI, 0))
+    writeBytes(ASCII_FS, '.');
 }
 
 void Adafruit_Thermal::test() {
@@ -280,31 +1343,695 @@ void Adafruit_Thermal::setBarcodeHeight(uint8_t val) { // Default is 50
   if (val < 1)
     val = 1;
   barcodeHeight = val;
-  writeBytes(ASCII_GS, 'h', val);
+  if (stateChanged(SHADOW_BARCODE, val))
+    writeBytes(ASCII_GS, 'h', val);
 }
 
-void Adafruit_Thermal::printBarcode(const char *text, uint8_t type) {
-  feed(1); // Recent firmware can't print barcode w/o feed first???
-  if (firmware >= 264)
-    type += 65;
-  writeBytes(ASCII_GS, 'H', 2);    // Print label below barcode
-  writeBytes(ASCII_GS, 'w', 3);    // Barcode width 3 (0.375/1.0mm thin/thick)
-  writeBytes(ASCII_GS, 'k', type); // Barcode type (listed in .h file)
-  if (firmware >= 264) {
-    int len = strlen(text);
-    if (len > 255)
-      len = 255;
-    writeBytes(len); // Write length byte
-    for (uint8_t i = 0; i < len; i++)
-      writeBytes(text[i]); // Write string sans NUL
+// Width and text position are sent with the next barcode, and only if
+// they differ from what the printer already has.
+void Adafruit_Thermal::setBarcodeWidth(uint8_t val) {
+  barcodeWidth = (val < 2) ? 2 : (val > 6) ? 6 : val;
+}
+
+void Adafruit_Thermal::setBarcodeLabel(uint8_t position) {
+  barcodeLabel = position & BARCODE_LABEL_BOTH;
+}
+
+// Barcodes are checked against their symbology's rules before anything
+// is sent, since the printer either ignores a code it can't encode or
+// prints part of one.  The leading feed, any style commands that have
+// changed and the GS k header then go out as one write and the text as
+// another, straight from the caller's string, paced like bitmap rows.
+// The print time follows from the code's width in modules: each dot row
+// of bars fires about half of them, which matters with density timing.
+
+#define BARCODE_DIGITS 0  //!< 0-9 only
+#define BARCODE_CODE39 1  //!< 0-9, A-Z, space and $%*+-./
+#define BARCODE_CODABAR 2 //!< 0-9, A-D, a-d and $+-./:
+#define BARCODE_ASCII 3   //!< Any 7-bit character
+
+#define BARCODE_LABEL_ROWS 30 //!< Dot rows for a line of barcode text
+
+//! Length, character and size rules for a barcodes type
+struct BarcodeRule {
+  uint8_t minLen;   //!< Fewest characters
+  uint8_t maxLen;   //!< Most characters
+  uint8_t chars;    //!< BARCODE_* character set
+  uint8_t modules;  //!< Modules per character
+  uint8_t overhead; //!< Modules not tied to characters (guards, etc.)
+};
+
+static const BarcodeRule PROGMEM barcodeRules[] = {
+    {11, 12, BARCODE_DIGITS, 0, 95},   // UPC_A (fixed width)
+    {6, 12, BARCODE_DIGITS, 0, 51},    // UPC_E
+    {12, 13, BARCODE_DIGITS, 0, 95},   // EAN13
+    {7, 8, BARCODE_DIGITS, 0, 67},     // EAN8
+    {1, 255, BARCODE_CODE39, 16, 32},  // CODE39, with * start and stop
+    {2, 254, BARCODE_DIGITS, 9, 9},    // ITF, digits in pairs
+    {1, 255, BARCODE_CODABAR, 12, 0},  // CODABAR
+    {1, 255, BARCODE_ASCII, 9, 37},    // CODE93, with two check characters
+    {2, 255, BARCODE_ASCII, 11, 35},   // CODE128, with start and check
+};
+
+static bool barcodeChar(uint8_t set, char c) {
+  if ((c >= '0') && (c <= '9'))
+    return true;
+  switch (set) {
+  case BARCODE_CODE39:
+    // '*' is the start/stop character, which the printer adds itself
+    return ((c >= 'A') && (c <= 'Z')) || strchr(" $%+-./", c);
+  case BARCODE_CODABAR:
+    return ((c >= 'A') && (c <= 'D')) || ((c >= 'a') && (c <= 'd')) ||
+           strchr("$+-./:", c);
+  case BARCODE_ASCII:
+    return !(c & 0x80);
+  }
+  return false;
+}
+
+// Modules across a barcode of len characters, or 0 if the text doesn't
+// fit the type's rules.  Types outside the barcodes enum (raw datasheet
+// values) aren't checked, and are timed as the largest of the 1D codes.
+static uint16_t barcodeModules(const char *text, size_t len, uint8_t type) {
+  if (type >= sizeof barcodeRules / sizeof barcodeRules[0])
+    return 95;
+  BarcodeRule r;
+  memcpy_P(&r, &barcodeRules[type], sizeof r);
+  if ((len < r.minLen) || (len > r.maxLen) || ((type == ITF) && (len & 1)))
+    return 0;
+  for (size_t i = 0; i < len; i++)
+    if (!barcodeChar(r.chars, text[i]))
+      return 0;
+  return r.modules * len + r.overhead;
+}
+
+bool Adafruit_Thermal::printBarcode(const char *text, uint8_t type) {
+  size_t len = strlen(text);
+  uint16_t modules = barcodeModules(text, len, type);
+  uint8_t frame[13], n = 0;
+  bool counted = (firmware >= 264); // Length byte, no NUL terminator
+  unsigned long t;
+
+  if (!modules)
+    return false;
+  flushStyle();
+  // Recent firmware can't print barcode w/o feed first???
+  if (counted) {
+    frame[n++] = ASCII_ESC;
+    frame[n++] = 'd';
+    frame[n++] = 1;
   } else {
-    uint8_t c, i = 0;
-    do { // Copy string + NUL terminator
-      writeBytes(c = text[i++]);
-    } while (c);
+    feed(1); // Old firmware feeds with newlines
+  }
+  if (stateChanged(SHADOW_BARLABEL, barcodeLabel)) {
+    frame[n++] = ASCII_GS;
+    frame[n++] = 'H';
+    frame[n++] = barcodeLabel;
+  }
+  if (stateChanged(SHADOW_BARWIDTH, barcodeWidth)) {
+    frame[n++] = ASCII_GS;
+    frame[n++] = 'w';
+    frame[n++] = barcodeWidth;
+  }
+  frame[n++] = ASCII_GS;
+  frame[n++] = 'k';
+  frame[n++] = counted ? type + 65 : type; // Barcode type (listed in .h file)
+  if (counted)
+    frame[n++] = len;
+  else
+    len++; // Send the string's NUL terminator too
+
+  commitBytes();
+  STATS_KIND(STATS_BARCODE);
+  sendBlock(frame, n);
+  sendBlock((const uint8_t *)text, len);
+
+  t = counted ? dotFeedTime * charHeight : 0;
+  t += barcodeHeight * rowPrintTime(modules * barcodeWidth / 2);
+  if (barcodeLabel & BARCODE_LABEL_ABOVE)
+    t += BARCODE_LABEL_ROWS * dotPrintTime;
+  if (barcodeLabel & BARCODE_LABEL_BELOW)
+    t += BARCODE_LABEL_ROWS * dotPrintTime;
+  timeoutExtend(t);
+  STATS_KIND(STATS_COMMAND);
+  lineDots = lineHeight = 0;
+  return true;
+}
+
+// === 2D symbols ===
+// Printers with the full ESC/POS set draw QR codes and PDF417 symbols
+// themselves from GS ( k commands: the payload is stored, then printed,
+// so only the text crosses the serial line.  For QR codes on other
+// printers the symbol is encoded here (byte mode, model 2) and sent as
+// a bitmap.  The encoder follows ISO/IEC 18004 as laid out in Project
+// Nayuki's QR Code generator: data and Reed-Solomon codewords are built,
+// interleaved and placed in a packed module grid, then the mask with the
+// lowest penalty score is applied.  Rows of the grid are scaled up to
+// printer rows only as printBitmapRows() asks for them.
+
+// Error correction codewords per block, by level then version
+static const uint8_t PROGMEM qrEccPerBlock[4][40] = {
+    {7,  10, 15, 20, 26, 18, 20, 24, 30, 18, 20, 24, 26, 30,
+     22, 24, 28, 30, 28, 28, 28, 28, 30, 30, 26, 28, 30, 30,
+     30, 30, 30, 30, 30, 30, 30, 30, 30, 30, 30, 30},
+    {10, 16, 26, 18, 24, 16, 18, 22, 22, 26, 30, 22, 22, 24,
+     24, 28, 28, 26, 26, 26, 26, 28, 28, 28, 28, 28, 28, 28,
+     28, 28, 28, 28, 28, 28, 28, 28, 28, 28, 28, 28},
+    {13, 22, 18, 26, 18, 24, 18, 22, 20, 24, 28, 26, 24, 20,
+     30, 24, 28, 28, 26, 30, 28, 30, 30, 30, 30, 28, 30, 30,
+     30, 30, 30, 30, 30, 30, 30, 30, 30, 30, 30, 30},
+    {17, 28, 22, 16, 22, 28, 26, 26, 24, 28, 24, 28, 22, 24,
+     24, 30, 28, 28, 26, 28, 30, 24, 30, 30, 30, 30, 30, 30,
+     30, 30, 30, 30, 30, 30, 30, 30, 30, 30, 30, 30}};
+
+// Error correction blocks, by level then version
+static const uint8_t PROGMEM qrBlocks[4][40] = {
+    {1,  1,  1,  1,  1,  2,  2,  2,  2,  4,  4,  4,  4,  4,
+     6,  6,  6,  6,  7,  8,  8,  9,  9,  10, 12, 12, 12, 13,
+     14, 15, 16, 17, 18, 19, 19, 20, 21, 22, 24, 25},
+    {1,  1,  1,  2,  2,  4,  4,  4,  5,  5,  5,  8,  9,  9,
+     10, 10, 11, 13, 14, 16, 17, 17, 18, 20, 21, 23, 25, 26,
+     28, 29, 31, 33, 35, 37, 38, 40, 43, 45, 47, 49},
+    {1,  1,  2,  2,  4,  4,  6,  6,  8,  8,  8,  10, 12, 16,
+     12, 17, 16, 18, 21, 20, 23, 23, 25, 27, 29, 34, 34, 35,
+     38, 40, 43, 45, 48, 51, 53, 56, 59, 62, 65, 68},
+    {1,  1,  2,  4,  4,  4,  5,  6,  8,  8,  11, 11, 16, 16,
+     18, 16, 19, 21, 25, 25, 25, 34, 30, 32, 35, 37, 40, 42,
+     45, 48, 51, 54, 57, 60, 63, 66, 70, 74, 77, 81}};
+
+#define QR_MAX_SIZE (THERMAL_QR_VERSION_MAX * 4 + 17) //!< Modules per side
+#define QR_BUFFER_LEN (((QR_MAX_SIZE + 7) / 8) * QR_MAX_SIZE) //!< Grid bytes
+
+//! A QR code's module grid: one bit per module, rows padded to bytes
+struct QRGrid {
+  uint8_t *bits;    //!< size rows of rowBytes, MSB first, 1 = dark
+  uint8_t size;     //!< Modules per side
+  uint8_t rowBytes; //!< Bytes per row of bits
+};
+
+static bool qrGet(const QRGrid *g, int x, int y) {
+  return (g->bits[y * g->rowBytes + (x >> 3)] >> (7 - (x & 7))) & 1;
+}
+
+static void qrSet(QRGrid *g, int x, int y, bool dark) {
+  if ((x < 0) || (y < 0) || (x >= g->size) || (y >= g->size))
+    return;
+  uint8_t *b = &g->bits[y * g->rowBytes + (x >> 3)];
+  if (dark)
+    *b |= 0x80 >> (x & 7);
+  else
+    *b &= ~(0x80 >> (x & 7));
+}
+
+static void qrFill(QRGrid *g, int x, int y, int w, int h) {
+  for (int dy = 0; dy < h; dy++)
+    for (int dx = 0; dx < w; dx++)
+      qrSet(g, x + dx, y + dy, true);
+}
+
+// Modules a version has for data and error correction codewords.
+static uint16_t qrRawModules(uint8_t ver) {
+  uint16_t n = (16 * ver + 128) * ver + 64;
+  if (ver >= 2) {
+    uint8_t align = ver / 7 + 2;
+    n -= (25 * align - 10) * align - 55;
+    if (ver >= 7)
+      n -= 36; // Version information
+  }
+  return n;
+}
+
+static uint16_t qrDataCodewords(uint8_t ver, uint8_t ecc) {
+  return qrRawModules(ver) / 8 -
+         pgm_read_byte(&qrEccPerBlock[ecc][ver - 1]) *
+             pgm_read_byte(&qrBlocks[ecc][ver - 1]);
+}
+
+// Smallest version (up to maxVer) that holds len bytes, or 0 if none.
+static uint8_t qrVersion(uint16_t len, uint8_t ecc, uint8_t maxVer) {
+  for (uint8_t ver = 1; ver <= maxVer; ver++) {
+    uint32_t bits = 4 + ((ver <= 9) ? 8 : 16) + 8UL * len;
+    if (bits <= qrDataCodewords(ver, ecc) * 8UL)
+      return ver;
+  }
+  return 0;
+}
+
+// Centers of the alignment patterns along either axis; returns the count.
+static uint8_t qrAlignment(uint8_t ver, uint8_t *pos) {
+  if (ver == 1)
+    return 0;
+  uint8_t n = ver / 7 + 2, step = (ver * 8 + n * 3 + 5) / (n * 4 - 4) * 2;
+  pos[0] = 6;
+  for (uint8_t i = n - 1, p = ver * 4 + 10; i >= 1; i--, p -= step)
+    pos[i] = p;
+  return n;
+}
+
+// Product in GF(2^8) modulo x^8 + x^4 + x^3 + x^2 + 1.
+static uint8_t gfMultiply(uint8_t x, uint8_t y) {
+  uint8_t z = 0;
+  for (int8_t i = 7; i >= 0; i--) {
+    z = (z << 1) ^ ((z >> 7) * 0x1D);
+    z ^= ((y >> i) & 1) * x;
+  }
+  return z;
+}
+
+// Appends Reed-Solomon codewords to each block of the data codewords in
+// data[] and interleaves the blocks into out[].
+static void qrAddEcc(uint8_t *data, uint8_t ver, uint8_t ecc, uint8_t *out) {
+  uint8_t blocks = pgm_read_byte(&qrBlocks[ecc][ver - 1]),
+          eccLen = pgm_read_byte(&qrEccPerBlock[ecc][ver - 1]), gen[30];
+  uint16_t raw = qrRawModules(ver) / 8, dataLen = qrDataCodewords(ver, ecc);
+  uint8_t shortBlocks = blocks - raw % blocks;
+  uint16_t shortLen = raw / blocks - eccLen;
+
+  // Generator polynomial, highest coefficient (always 1) left off
+  memset(gen, 0, eccLen);
+  gen[eccLen - 1] = 1;
+  for (uint8_t i = 0, root = 1; i < eccLen; i++) {
+    for (uint8_t j = 0; j < eccLen; j++) {
+      gen[j] = gfMultiply(gen[j], root);
+      if (j + 1 < eccLen)
+        gen[j] ^= gen[j + 1];
+    }
+    root = gfMultiply(root, 0x02);
+  }
+
+  const uint8_t *block = data;
+  uint8_t *rem = &data[dataLen]; // Scratch space after the data
+  for (uint8_t i = 0; i < blocks; i++) {
+    uint16_t len = shortLen + ((i < shortBlocks) ? 0 : 1), j, k;
+    memset(rem, 0, eccLen);
+    for (j = 0; j < len; j++) { // Polynomial division remainder
+      uint8_t factor = block[j] ^ rem[0];
+      memmove(rem, rem + 1, eccLen - 1);
+      rem[eccLen - 1] = 0;
+      for (k = 0; k < eccLen; k++)
+        rem[k] ^= gfMultiply(gen[k], factor);
+    }
+    for (j = 0, k = i; j < len; j++, k += blocks) {
+      if (j == shortLen) // Long blocks' extra byte comes after the rest
+        k -= shortBlocks;
+      out[k] = block[j];
+    }
+    for (j = 0, k = dataLen + i; j < eccLen; j++, k += blocks)
+      out[k] = rem[j];
+    block += len;
+  }
+}
+
+// Marks every function module (finders, timing, alignment, format and
+// version areas) dark and everything else light.
+static void qrFunctionModules(QRGrid *g, uint8_t ver) {
+  uint8_t pos[7], n = qrAlignment(ver, pos), s = g->size;
+  memset(g->bits, 0, g->rowBytes * s);
+  qrFill(g, 6, 0, 1, s); // Timing patterns
+  qrFill(g, 0, 6, s, 1);
+  qrFill(g, 0, 0, 9, 9); // Finders with separators and format bits
+  qrFill(g, s - 8, 0, 8, 9);
+  qrFill(g, 0, s - 8, 9, 8);
+  for (uint8_t i = 0; i < n; i++)
+    for (uint8_t j = 0; j < n; j++)
+      if (!((i == 0 && j == 0) || (i == 0 && j == n - 1) ||
+            (i == n - 1 && j == 0)))
+        qrFill(g, pos[i] - 2, pos[j] - 2, 5, 5);
+  if (ver >= 7) { // Version information
+    qrFill(g, s - 11, 0, 3, 6);
+    qrFill(g, 0, s - 11, 6, 3);
+  }
+}
+
+// Clears the light modules of the function patterns filled in above.
+static void qrLightModules(QRGrid *g, uint8_t ver) {
+  uint8_t pos[7], n = qrAlignment(ver, pos), s = g->size;
+  for (int i = 7; i < s - 7; i += 2) {
+    qrSet(g, 6, i, false);
+    qrSet(g, i, 6, false);
+  }
+  for (int dy = -4; dy <= 4; dy++) {
+    for (int dx = -4; dx <= 4; dx++) {
+      int d = (abs(dx) > abs(dy)) ? abs(dx) : abs(dy);
+      if ((d == 2) || (d == 4)) {
+        qrSet(g, 3 + dx, 3 + dy, false);
+        qrSet(g, s - 4 + dx, 3 + dy, false);
+        qrSet(g, 3 + dx, s - 4 + dy, false);
+      }
+    }
+  }
+  for (uint8_t i = 0; i < n; i++)
+    for (uint8_t j = 0; j < n; j++)
+      if (!((i == 0 && j == 0) || (i == 0 && j == n - 1) ||
+            (i == n - 1 && j == 0)))
+        for (int dy = -1; dy <= 1; dy++)
+          for (int dx = -1; dx <= 1; dx++)
+            qrSet(g, pos[i] + dx, pos[j] + dy, !dx && !dy);
+  if (ver >= 7) {
+    uint32_t rem = ver;
+    for (uint8_t i = 0; i < 12; i++)
+      rem = (rem << 1) ^ ((rem >> 11) * 0x1F25);
+    uint32_t bits = ((uint32_t)ver << 12) | rem;
+    for (uint8_t i = 0; i < 6; i++) {
+      for (uint8_t j = 0; j < 3; j++, bits >>= 1) {
+        qrSet(g, s - 11 + j, i, bits & 1);
+        qrSet(g, i, s - 11 + j, bits & 1);
+      }
+    }
+  }
+}
+
+// Writes both copies of the format information for a level and mask.
+static void qrFormatBits(QRGrid *g, uint8_t ecc, uint8_t mask) {
+  static const uint8_t PROGMEM levelBits[4] = {1, 0, 3, 2};
+  uint16_t data = (pgm_read_byte(&levelBits[ecc]) << 3) | mask, rem = data;
+  for (uint8_t i = 0; i < 10; i++)
+    rem = (rem << 1) ^ ((rem >> 9) * 0x537);
+  uint16_t bits = ((data << 10) | rem) ^ 0x5412;
+  uint8_t s = g->size, i;
+  for (i = 0; i <= 5; i++)
+    qrSet(g, 8, i, (bits >> i) & 1);
+  qrSet(g, 8, 7, (bits >> 6) & 1);
+  qrSet(g, 8, 8, (bits >> 7) & 1);
+  qrSet(g, 7, 8, (bits >> 8) & 1);
+  for (i = 9; i < 15; i++)
+    qrSet(g, 14 - i, 8, (bits >> i) & 1);
+  for (i = 0; i < 8; i++)
+    qrSet(g, s - 1 - i, 8, (bits >> i) & 1);
+  for (i = 8; i < 15; i++)
+    qrSet(g, 8, s - 15 + i, (bits >> i) & 1);
+  qrSet(g, 8, s - 8, true); // The dark module
+}
+
+// Places codewords in the zigzag order, in the modules still light.
+static void qrCodewords(QRGrid *g, const uint8_t *cw, uint16_t len) {
+  uint16_t i = 0;
+  for (int right = g->size - 1; right >= 1; right -= 2) {
+    if (right == 6)
+      right = 5; // Skip the vertical timing pattern
+    bool upward = !((right + 1) & 2);
+    for (int v = 0; v < g->size; v++) {
+      int y = upward ? g->size - 1 - v : v;
+      for (int j = 0; j < 2; j++) {
+        int x = right - j;
+        if (!qrGet(g, x, y) && (i < len * 8)) {
+          qrSet(g, x, y, (cw[i >> 3] >> (7 - (i & 7))) & 1);
+          i++;
+        }
+        // Remainder modules are left light
+      }
+    }
+  }
+}
+
+// XORs a mask pattern over the modules that aren't function modules.
+// Applying the same mask twice undoes it.
+static void qrMask(QRGrid *g, const QRGrid *func, uint8_t mask) {
+  for (int y = 0; y < g->size; y++) {
+    for (int x = 0; x < g->size; x++) {
+      bool flip;
+      if (qrGet(func, x, y))
+        continue;
+      switch (mask) {
+      case 0:
+        flip = !((x + y) % 2);
+        break;
+      case 1:
+        flip = !(y % 2);
+        break;
+      case 2:
+        flip = !(x % 3);
+        break;
+      case 3:
+        flip = !((x + y) % 3);
+        break;
+      case 4:
+        flip = !((x / 3 + y / 2) % 2);
+        break;
+      case 5:
+        flip = !(x * y % 2 + x * y % 3);
+        break;
+      case 6:
+        flip = !((x * y % 2 + x * y % 3) % 2);
+        break;
+      default:
+        flip = !(((x + y) % 2 + x * y % 3) % 2);
+        break;
+      }
+      if (flip)
+        g->bits[y * g->rowBytes + (x >> 3)] ^= 0x80 >> (x & 7);
+    }
+  }
+}
+
+// Run-length history for the finder-like pattern penalty.  The quiet
+// zone counts as a light run before the first and after the last.
+static void qrAddRun(uint16_t run, uint16_t *h, uint8_t size) {
+  if (!h[0])
+    run += size; // First run: add the light border
+  memmove(h + 1, h, 6 * sizeof h[0]);
+  h[0] = run;
+}
+
+static uint8_t qrFinderRuns(const uint16_t *h) {
+  uint16_t n = h[1];
+  bool core = n && (h[2] == n) && (h[3] == n * 3) && (h[4] == n) &&
+              (h[5] == n);
+  return ((core && (h[0] >= n * 4) && (h[6] >= n)) ? 1 : 0) +
+         ((core && (h[6] >= n * 4) && (h[0] >= n)) ? 1 : 0);
+}
+
+// Penalty score of a masked grid (lower is easier to scan).
+static uint32_t qrPenalty(const QRGrid *g) {
+  uint32_t score = 0;
+  uint16_t dark = 0, h[7];
+  uint8_t s = g->size;
+  for (uint8_t pass = 0; pass < 2; pass++) { // Rows, then columns
+    for (int a = 0; a < s; a++) {
+      bool color = false;
+      uint16_t run = 0;
+      memset(h, 0, sizeof h);
+      for (int b = 0; b < s; b++) {
+        bool m = pass ? qrGet(g, a, b) : qrGet(g, b, a);
+        if (m == color) {
+          run++;
+          if (run == 5)
+            score += 3;
+          else if (run > 5)
+            score++;
+        } else {
+          qrAddRun(run, h, s);
+          if (!color)
+            score += qrFinderRuns(h) * 40;
+          color = m;
+          run = 1;
+        }
+      }
+      if (color) { // Close the run, then the light border after it
+        qrAddRun(run, h, s);
+        run = 0;
+      }
+      qrAddRun(run + s, h, s);
+      score += qrFinderRuns(h) * 40;
+    }
+  }
+  for (int y = 0; y < s; y++) {
+    for (int x = 0; x < s; x++) {
+      bool m = qrGet(g, x, y);
+      dark += m;
+      if ((x < s - 1) && (y < s - 1) && (m == qrGet(g, x + 1, y)) &&
+          (m == qrGet(g, x, y + 1)) && (m == qrGet(g, x + 1, y + 1)))
+        score += 3;
+    }
+  }
+  // 10 points for each 5% that the dark share is away from half
+  uint32_t total = (uint32_t)s * s,
+           off = ((dark * 20UL > total * 10) ? dark * 20UL - total * 10
+                                             : total * 10 - dark * 20UL);
+  return score + ((off + total - 1) / total - 1) * 10;
+}
+
+// Encodes len bytes as a QR code of the given version in g, using work
+// (another buffer the size of g's) as scratch.
+static void qrEncode(QRGrid *g, uint8_t *work, const char *text, uint16_t len,
+                     uint8_t ver, uint8_t ecc) {
+  uint16_t cap = qrDataCodewords(ver, ecc), bit = 0, i;
+  uint8_t *data = g->bits; // Codewords are built in the grid's own buffer
+  QRGrid func = {work, g->size, g->rowBytes};
+
+  // Byte mode segment, terminator, then pad bytes
+  memset(data, 0, cap);
+  uint8_t ccBits = (ver <= 9) ? 8 : 16;
+  uint32_t head = (0x4UL << ccBits) | len;
+  for (int8_t b = 4 + ccBits - 1; b >= 0; b--, bit++)
+    data[bit >> 3] |= ((head >> b) & 1) << (7 - (bit & 7));
+  for (i = 0; i < len; i++, bit += 8) {
+    uint8_t c = text[i];
+    data[bit >> 3] |= c >> (bit & 7);
+    if (bit & 7)
+      data[(bit >> 3) + 1] |= c << (8 - (bit & 7));
+  }
+  bit = (bit + 4 < cap * 8) ? bit + 4 : cap * 8; // Terminator
+  for (i = (bit + 7) / 8; i < cap; i++)
+    data[i] = ((i - (bit + 7) / 8) & 1) ? 0x11 : 0xEC;
+
+  qrAddEcc(data, ver, ecc, work);
+  qrFunctionModules(g, ver);
+  qrCodewords(g, work, qrRawModules(ver) / 8);
+  qrLightModules(g, ver);
+  qrFunctionModules(&func, ver);
+
+  uint8_t best = 0;
+  uint32_t bestScore = 0xFFFFFFFFUL;
+  for (uint8_t mask = 0; mask < 8; mask++) {
+    qrMask(g, &func, mask);
+    qrFormatBits(g, ecc, mask);
+    uint32_t score = qrPenalty(g);
+    if (score < bestScore) {
+      best = mask;
+      bestScore = score;
+    }
+    qrMask(g, &func, mask);
+  }
+  qrMask(g, &func, best);
+  qrFormatBits(g, ecc, best);
+}
+
+//! Row source state for QR codes encoded on the MCU
+struct QRCodeSource {
+  QRGrid grid;   //!< The finished symbol
+  uint8_t scale; //!< Dots per module
+};
+
+#define QR_QUIET 4 //!< Light modules around a QR code
+
+static const uint8_t *getQRRow(void *ctx, int y, uint8_t *buf, uint8_t n) {
+  QRCodeSource *src = (QRCodeSource *)ctx;
+  int my = y / src->scale - QR_QUIET;
+  memset(buf, 0, n);
+  if ((my < 0) || (my >= src->grid.size))
+    return buf;
+  for (int x = 0; x < n * 8; x++) {
+    int mx = x / src->scale - QR_QUIET;
+    if ((mx >= 0) && (mx < src->grid.size) && qrGet(&src->grid, mx, my))
+      buf[x >> 3] |= 0x80 >> (x & 7);
+  }
+  return buf;
+}
+
+#define PDF417_MAX_TEXT 1850   //!< Most characters a PDF417 symbol holds
+#define PDF417_MAX_DIGITS 2710 //!< ...or digits, in numeric compaction
+
+// GS ( k with a one-byte parameter: function fn of symbol type cn.
+void Adafruit_Thermal::writeSymbol(uint8_t cn, uint8_t fn, uint8_t n) {
+  writeBytes(ASCII_GS, '(', 'k', 3, 0);
+  writeBytes(cn, fn, n);
+}
+
+// Stores a symbol's data in the printer, ready for its print function.
+// Callers keep len to what the symbol can hold, well short of the point
+// where pL pH (len + 3) would wrap.  The data goes out as blocks, like
+// a barcode's, rather than through the command staging buffer.
+void Adafruit_Thermal::storeSymbol(uint8_t cn, const char *text,
+                                   uint16_t len) {
+  uint8_t header[] = {ASCII_GS, '(', 'k', (uint8_t)((len + 3) & 0xFF),
+                      (uint8_t)((len + 3) >> 8), cn, 'P', '0'};
+  commitBytes();
+  sendBlock(header, sizeof header);
+  sendBlock((const uint8_t *)text, len);
+}
+
+bool Adafruit_Thermal::printQRCode(const char *text, uint8_t moduleSize,
+                                   uint8_t ecc) {
+  size_t n = strlen(text);
+  uint16_t len = (n > 0xFFFF) ? 0xFFFF : n; // Too long for any version
+  bool native = (firmware >= FIRMWARE_ESCPOS);
+  uint8_t ver;
+
+  if (ecc > QR_ECC_H)
+    ecc = QR_ECC_H;
+  moduleSize = (moduleSize < 1) ? 1 : (moduleSize > 16) ? 16 : moduleSize;
+  if (!(ver = qrVersion(len, ecc, native ? 40 : THERMAL_QR_VERSION_MAX)))
+    return false;
+  uint8_t size = ver * 4 + 17;
+  while ((moduleSize > 1) && ((size + 2 * QR_QUIET) * moduleSize > 384))
+    moduleSize--;
+
+  if (native) {
+    flushStyle();
+    STATS_KIND(STATS_BARCODE);
+    beginBatch();
+    writeBytes(ASCII_GS, '(', 'k', 4, 0);
+    writeBytes('1', 'A', '2', 0); // Model 2
+    writeSymbol('1', 'C', moduleSize);
+    writeSymbol('1', 'E', '0' + ecc);
+    storeSymbol('1', text, len);
+    writeSymbol('1', 'Q', '0');
+    endBatch();
+    // The printer may pick a smaller version than byte mode needs, so
+    // this errs on the long side
+    timeoutSet((unsigned long)size * moduleSize * dotPrintTime);
+    STATS_KIND(STATS_COMMAND);
+    lineDots = lineHeight = 0;
+    return true;
+  }
+
+  uint8_t bits[QR_BUFFER_LEN], work[QR_BUFFER_LEN];
+  QRCodeSource src = {{bits, size, (uint8_t)((size + 7) / 8)}, moduleSize};
+  qrEncode(&src.grid, work, text, len, ver, ecc);
+  int dots = (size + 2 * QR_QUIET) * moduleSize;
+  return printBitmapRows(dots, dots, getQRRow, &src, true);
+}
+
+bool Adafruit_Thermal::printPDF417(const char *text, uint8_t moduleWidth,
+                                   uint8_t rowHeight, uint8_t ecc,
+                                   uint8_t columns) {
+  if (firmware < FIRMWARE_ESCPOS)
+    return false;
+  size_t n = strlen(text);
+  if (n > PDF417_MAX_TEXT) {
+    if (n > PDF417_MAX_DIGITS)
+      return false;
+    for (size_t i = 0; i < n; i++) {
+      if ((text[i] < '0') || (text[i] > '9'))
+        return false;
+    }
   }
-  timeoutSet((barcodeHeight + 40) * dotPrintTime);
-  prevByte = '\n';
+  uint16_t len = n;
+  moduleWidth = (moduleWidth < 2) ? 2 : (moduleWidth > 8) ? 8 : moduleWidth;
+  rowHeight = (rowHeight < 2) ? 2 : (rowHeight > 8) ? 8 : rowHeight;
+  if (ecc > 8)
+    ecc = 8;
+  if (columns > 30)
+    columns = 30;
+
+  flushStyle();
+  STATS_KIND(STATS_BARCODE);
+  beginBatch();
+  writeSymbol('0', 'A', columns);
+  writeSymbol('0', 'B', 0); // Rows follow from the columns
+  writeSymbol('0', 'C', moduleWidth);
+  writeSymbol('0', 'D', rowHeight);
+  writeBytes(ASCII_GS, '(', 'k', 4, 0);
+  writeBytes('0', 'E', '0', '0' + ecc);
+  writeSymbol('0', 'F', 0); // Standard (not truncated) PDF417
+  storeSymbol('0', text, len);
+  writeSymbol('0', 'Q', '0');
+  endBatch();
+
+  // Rough print time: byte compaction packs 6 bytes in 5 codewords, and
+  // each row holds 'columns' codewords between 4 columns of overhead
+  int cols = columns ? columns : (384 / moduleWidth - 1) / 17 - 4;
+  if (cols < 1)
+    cols = 1;
+  unsigned long cw = len * 5UL / 6 + 2 + (2UL << ecc),
+                rows = (cw + cols - 1) / cols;
+  if (rows < 3)
+    rows = 3;
+  timeoutSet(rows * rowHeight * moduleWidth * dotPrintTime);
+  STATS_KIND(STATS_COMMAND);
+  lineDots = lineHeight = 0;
+  return true;
 }
 
 // === Character commands ===
@@ -320,6 +2047,106 @@ void Adafruit_Thermal::printBarcode(const char *text, uint8_t type) {
 
 
 
+// Text layout.  The printer wraps a line when the next character won't
+// fit in its 384 dots, so the line width is tracked in dots: each glyph
+// is its font's width (or its own, for user-defined characters) plus
+// the character spacing, all doubled in double-width mode.  A line's
+// print time is charged when it ends, whether by newline or by the
+// printer wrapping it, using the tallest character on it; a line with
+// nothing on it is just fed.
+
+// Width in dots that character c will take on the line.
+uint8_t Adafruit_Thermal::glyphWidth(uint8_t c) {
+  uint8_t w = charWidth, n;
+  if (c < ' ')
+    return 0;
+  if (userChars && (c < 128) &&
+      (n = (userWidths[(c - 32) >> 1] >> ((c & 1) << 2)) & 0x0F)) {
+    w = (printMode & DOUBLE_WIDTH_MASK) ? n * 2 : n;
+  }
+  return w + ((printMode & DOUBLE_WIDTH_MASK) ? charSpacing * 2 : charSpacing);
+}
+
+// Rough dots fired per row by a glyph w dots wide, for density timing.
+// Strokes light about a quarter of a glyph's row (a third, when bold);
+// reverse printing lights the rest.
+uint8_t Adafruit_Thermal::glyphInk(uint8_t c, uint8_t w) {
+  uint8_t ink = (c == ' ') ? 0 : (printMode & BOLD_MASK) ? w / 3 : w / 4;
+  if ((printMode & INVERSE_MASK) ||
+      ((shadowValid & (1UL << SHADOW_INVERSE)) && shadow[SHADOW_INVERSE]))
+    ink = w - ink;
+  return ink;
+}
+
+// Starts a new line, returning the time to print or feed the old one.
+unsigned long Adafruit_Thermal::endLine() {
+  unsigned long t;
+  if (lineHeight) // Text line
+    t = (lineHeight * rowPrintTime(lineInk)) + (lineSpacing * dotFeedTime);
+  else // Feed line
+    t = (charHeight + lineSpacing) * dotFeedTime;
+  lineDots = 0;
+  lineInk = 0;
+  lineHeight = 0;
+  return t;
+}
+
+// Sends one character of text and accounts for its place on the line.
+void Adafruit_Thermal::putChar(uint8_t c) {
+  waitCredit(1);
+  STATS_KIND(STATS_TEXT);
+  sendBytes(&c, 1);
+  STATS_KIND(STATS_COMMAND);
+  unsigned long d = BYTE_TIME;
+  if (c == '\n') {
+    d += endLine();
+  } else if (c == ASCII_TAB) { // Past the last stop, HT is ignored
+    uint16_t stop = (lineDots / TAB_DOTS + 1) * TAB_DOTS;
+    if (stop <= TAB_LAST)
+      lineDots = stop;
+  } else {
+    uint8_t w = glyphWidth(c);
+    if (w) {
+      if (lineDots + w > LINE_DOTS) // Printer wraps before this character
+        d += endLine();
+      lineDots += w;
+      lineInk += glyphInk(c, w);
+      if (charHeight > lineHeight)
+        lineHeight = charHeight;
+    }
+  }
+  timeoutExtend(d);
+}
+
+// Places the held-back word, on a new line if it won't fit on this one.
+void Adafruit_Thermal::flushWord() {
+  if (wordLen) {
+    uint8_t n = wordLen;
+    wordLen = 0; // Clear first; putChar() commits, which flushes too
+    if (lineDots && (lineDots + wordDots > LINE_DOTS))
+      putChar('\n');
+    wordDots = 0;
+    for (uint8_t i = 0; i < n; i++)
+      putChar(wordBuf[i]);
+  }
+}
+
+// Records user-defined character c's width (0 if undefined).
+void Adafruit_Thermal::setUserWidth(uint8_t c, uint8_t w) {
+  uint8_t shift = (c & 1) << 2;
+  if (w > 15)
+    w = 15;
+  c = (c - 32) >> 1;
+  userWidths[c] = (userWidths[c] & ~(0x0F << shift)) | (w << shift);
+}
+
+void Adafruit_Thermal::wordWrapOn() { wordWrap = true; }
+
+void Adafruit_Thermal::wordWrapOff() {
+  flushWord();
+  wordWrap = false;
+}
+
 void Adafruit_Thermal::adjustCharValues() {
   uint8_t currentFont = fontData & 7;
   switch (currentFont){
@@ -352,50 +2179,85 @@ void Adafruit_Thermal::adjustCharValues() {
   // Double Width Mode
   if (printMode & DOUBLE_WIDTH_MASK) {
     charWidth *= 2;
-    maxColumn /= 2;
   }
   // Double Height Mode
   if (printMode & DOUBLE_HEIGHT_MASK) {
     charHeight *= 2;
   }
-  maxColumn = (384 / charWidth);
 
   uint8_t fontStyle = (printMode & 32) << 2;                  //Copy Height info from Printmode
   fontStyle = fontStyle | ((printMode & 16) >> 1);            //Copy Width info from Printmode
   fontData = fontStyle | currentFont;                              
   
-  writeBytes(ASCII_ESC, 'M', currentFont, FIN_CMD);           //Set the Font
-  writeBytes(ASCII_GS, '!', fontStyle >> 3 , FIN_CMD);        //Set the Height & Width
+  beginBatch();
+  if (stateChanged(SHADOW_FONT, currentFont))
+    writeBytes(ASCII_ESC, 'M', currentFont, FIN_CMD);         //Set the Font
+  if (stateChanged(SHADOW_SIZE, fontStyle >> 3))
+    writeBytes(ASCII_GS, '!', fontStyle >> 3 , FIN_CMD);      //Set the Height & Width
 
-  if(autoLineHeight) {
+  if (autoLineHeight && stateChanged(SHADOW_LINE, charHeight + lineSpacing)) {
     writeBytes(ASCII_ESC, '3', charHeight + lineSpacing);   //Set LineHeight based on new font
   }  
+  endBatch();
 }
 
 void Adafruit_Thermal::setPrintMode(uint8_t mask) {
   printMode |= mask;
-  writePrintMode();
-  adjustCharValues();
+  styleChanged();
 }
 
 void Adafruit_Thermal::unsetPrintMode(uint8_t mask) {
   printMode &= ~mask;
-  writePrintMode();
-  adjustCharValues();
+  styleChanged();
+}
+
+// Called after printMode, fontData or autoLineHeight change.  Normally
+// the new style is sent right away; with deferStyleOn() it waits for
+// flushStyle(), so a run of setters costs a single update.
+void Adafruit_Thermal::styleChanged() {
+  if (styleDeferred) {
+    styleDirty = true;
+  } else {
+    beginBatch();
+    writePrintMode();
+    adjustCharValues();
+    endBatch();
+  }
+}
+
+// Sends deferred style changes.  Called before anything that prints or
+// depends on the character size.
+void Adafruit_Thermal::flushStyle() {
+  if (styleDirty) {
+    styleDirty = false;
+    beginBatch();
+    writePrintMode();
+    adjustCharValues();
+    endBatch();
+  }
+}
+
+void Adafruit_Thermal::deferStyleOn() { styleDeferred = true; }
+
+void Adafruit_Thermal::deferStyleOff() {
+  styleDeferred = false;
+  flushStyle();
 }
 
 void Adafruit_Thermal::writePrintMode() {
-  writeBytes(ASCII_ESC, '!', printMode);
+  if (stateChanged(SHADOW_MODE, printMode))
+    writeBytes(ASCII_ESC, '!', printMode);
 }
 
 void Adafruit_Thermal::normal() {
   printMode = 0;
-  writePrintMode();
+  styleChanged();
 }
 
 void Adafruit_Thermal::inverseOn() {
   if (firmware >= 268) {
-    writeBytes(ASCII_GS, 'B', 1);
+    if (stateChanged(SHADOW_INVERSE, 1))
+      writeBytes(ASCII_GS, 'B', 1);
   } else {
     setPrintMode(INVERSE_MASK);
   }
@@ -403,7 +2265,8 @@ void Adafruit_Thermal::inverseOn() {
 
 void Adafruit_Thermal::inverseOff() {
   if (firmware >= 268) {
-    writeBytes(ASCII_GS, 'B', 0);
+    if (stateChanged(SHADOW_INVERSE, 0))
+      writeBytes(ASCII_GS, 'B', 0);
   } else {
     unsetPrintMode(INVERSE_MASK);
   }
@@ -411,7 +2274,8 @@ void Adafruit_Thermal::inverseOff() {
 
 void Adafruit_Thermal::upsideDownOn() {
   if (firmware >= 268) {
-    writeBytes(ASCII_ESC, '{', 1);
+    if (stateChanged(SHADOW_UPDOWN, 1))
+      writeBytes(ASCII_ESC, '{', 1);
   } else {
     setPrintMode(UPDOWN_MASK);
   }
@@ -419,7 +2283,8 @@ void Adafruit_Thermal::upsideDownOn() {
 
 void Adafruit_Thermal::upsideDownOff() {
   if (firmware >= 268) {
-    writeBytes(ASCII_ESC, '{', 0);
+    if (stateChanged(SHADOW_UPDOWN, 0))
+      writeBytes(ASCII_ESC, '{', 0);
   } else {
     unsetPrintMode(UPDOWN_MASK);
   }
@@ -427,20 +2292,24 @@ void Adafruit_Thermal::upsideDownOff() {
 
 void Adafruit_Thermal::autoLineHeightOn() {
   autoLineHeight = true;
-  adjustCharValues();
+  styleChanged();
 }
 
 void Adafruit_Thermal::autoLineHeightOff() {
   autoLineHeight = false;
-  adjustCharValues();
+  styleChanged();
 }
 
 void Adafruit_Thermal::userCharacterSetOn() {
-  writeBytes(ASCII_ESC, '%', 1);  
+  userChars = true;
+  if (stateChanged(SHADOW_USERCHARS, 1))
+    writeBytes(ASCII_ESC, '%', 1);
 }
 
 void Adafruit_Thermal::userCharacterSetOff() {
-  writeBytes(ASCII_ESC, '%', 0);  
+  userChars = false;
+  if (stateChanged(SHADOW_USERCHARS, 0))
+    writeBytes(ASCII_ESC, '%', 0);
 }
 
 void Adafruit_Thermal::doubleHeightOn() { setPrintMode(DOUBLE_HEIGHT_MASK); }
@@ -474,16 +2343,18 @@ void Adafruit_Thermal::justify(char value) {
     break;
   }
 
-  writeBytes(ASCII_ESC, 'a', pos);
+  justification = pos;
+  if (stateChanged(SHADOW_JUSTIFY, pos))
+    writeBytes(ASCII_ESC, 'a', pos);
 }
 
 // Feeds by the specified number of lines
 void Adafruit_Thermal::feed(uint8_t x) {
+  flushStyle(); // Feed distance depends on the character height
   if (firmware >= 264) {
     writeBytes(ASCII_ESC, 'd', x);
     timeoutSet(dotFeedTime * charHeight);
-    prevByte = '\n';
-    column = 0;
+    lineDots = lineHeight = 0;
   } else {
     while (x--)
       write('\n'); // Feed manually; old firmware feeds excess lines
@@ -494,41 +2365,35 @@ void Adafruit_Thermal::feed(uint8_t x) {
 void Adafruit_Thermal::feedRows(uint8_t rows) {
   writeBytes(ASCII_ESC, 'J', rows);
   timeoutSet(rows * dotFeedTime);
-  prevByte = '\n';
-  column = 0;
+  if (dtrEnabled && rows) { // Time this feed in timeoutWait()
+    learnStart = micros();
+    learnRows = rows;
+    learnFeed = true;
+  }
+  lineDots = lineHeight = 0;
 }
 
 void Adafruit_Thermal::flush() { writeBytes(ASCII_FF); }
 
+// Both double-size bits are updated together, so switching size costs
+// one pass through the (cached) mode and font commands rather than two.
 void Adafruit_Thermal::setSize(char value) {
   uint8_t size;
 
   switch (toupper(value)) {
   default: // Small: standard width and height
-    // size = 0x00;
-    // charHeight = 24;
-    // maxColumn = 32;
-    doubleWidthOff();
-    doubleHeightOff();
+    size = 0;
     break;
   case 'M': // Medium: double height
-    // size = 0x01;
-    // charHeight = 48;
-    // maxColumn = 32;
-    doubleHeightOn();
-    doubleWidthOff();
+    size = DOUBLE_HEIGHT_MASK;
     break;
   case 'L': // Large: double width and height
-    // size = 0x11;
-    // charHeight = 48;
-    // maxColumn = 16;
-    doubleHeightOn();
-    doubleWidthOn();
+    size = DOUBLE_HEIGHT_MASK | DOUBLE_WIDTH_MASK;
     break;
   }
 
-  // writeBytes(ASCII_GS, '!', size);
-  // prevByte = '\n'; // Setting the size adds a linefeed
+  printMode = (printMode & ~(DOUBLE_HEIGHT_MASK | DOUBLE_WIDTH_MASK)) | size;
+  styleChanged();
 }
 
 // ESC 7 n1 n2 n3 Setting Control Parameter Command
@@ -550,8 +2415,11 @@ void Adafruit_Thermal::setSize(char value) {
 // but slower printing speed.
 void Adafruit_Thermal::setHeatConfig(uint8_t dots, uint8_t time,
                                      uint8_t interval) {
+  beginBatch();
   writeBytes(ASCII_ESC, '7');       // Esc 7 (print settings)
   writeBytes(dots, time, interval); // Heating dots, heat time, heat interval
+  endBatch();
+  heatDots = (dots + 1) * 8; // Units of 8 dots, minus 1
 }
 
 // Print density description from manual:
@@ -572,129 +2440,897 @@ void Adafruit_Thermal::setPrintDensity(uint8_t density, uint8_t breakTime) {
 void Adafruit_Thermal::underlineOn(uint8_t weight) {
   if (weight > 2)
     weight = 2;
-  writeBytes(ASCII_ESC, '-', weight);
+  if (stateChanged(SHADOW_UNDERLINE, weight))
+    writeBytes(ASCII_ESC, '-', weight);
 }
 
-void Adafruit_Thermal::underlineOff() { writeBytes(ASCII_ESC, '-', 0); }
+void Adafruit_Thermal::underlineOff() { underlineOn(0); }
+
+// Bitmaps are issued a whole row at a time.  Each row source below hands
+// printBitmapRows() a pointer to a row's clipped bytes: RAM images are
+// sent straight from the caller's array, while PROGMEM and stream images
+// are first copied into a small staging row.  Array sources can fetch
+// any row (they're "seekable"), which lets printBitmapRows() look ahead
+// when planning chunks; stream sources only ever return the next row.
+// A source returns NULL if it runs out of data; printBitmapRows() then
+// finishes the chunk in progress with blank rows (the printer is still
+// counting them) and ends the image.
+
+//! Row source state for bitmaps held in RAM or PROGMEM
+struct BitmapArraySource {
+  const uint8_t *bitmap; //!< Start of the image
+  int rowBytes;          //!< Full (unclipped) bytes per row
+  bool fromProgMem;      //!< True if bitmap is in flash
+};
+
+static const uint8_t *getArrayRow(void *ctx, int y, uint8_t *buf,
+                                  uint8_t n) {
+  BitmapArraySource *src = (BitmapArraySource *)ctx;
+  const uint8_t *row = src->bitmap + (long)y * src->rowBytes;
+  if (!src->fromProgMem)
+    return row; // Zero-copy, written directly from the bitmap
+  memcpy_P(buf, row, n);
+  return buf;
+}
 
-void Adafruit_Thermal::printBitmap(int w, int h, const uint8_t *bitmap,
-                                   bool fromProgMem) {
-  int rowBytes, rowBytesClipped, rowStart, chunkHeight, chunkHeightLimit, x, y,
-      i;
+// Stream images are double-buffered: one row is handed out to be sent
+// while the next is read into the other buffer.  Reading ahead is done
+// by getStreamPrefetch(), which takes only the bytes that have already
+// arrived, so it can run while printBitmapRows() waits for room in the
+// printer; getStreamRow() finishes the row with readBytes(), which gives
+// up after the stream's timeout.  Source and printer delays overlap
+// instead of adding up.
+
+//! Row source state for bitmaps read from a Stream
+struct BitmapStreamSource {
+  Stream *stream;      //!< Where the bitmap bytes come from
+  int rowBytes;        //!< Full (unclipped) bytes per row
+  int rowsLeft;        //!< Rows not yet read in full
+  int fill;            //!< Bytes of the next row read so far
+  uint8_t clip;        //!< Bytes kept per row (the rest are skipped)
+  uint8_t next;        //!< Buffer the next row goes in
+  bool failed;         //!< True once a read has timed out
+  uint8_t rows[2][48]; //!< The row being sent and the next one
+};
+
+// Reads up to n bytes of the next row, or fewer without waiting when
+// 'wait' is false.  Returns false if a waiting read timed out.
+static bool readStreamRow(BitmapStreamSource *src, int n, bool wait) {
+  uint8_t skip[16];
+  while (n > 0) {
+    int k, got;
+    if (src->fill < src->clip) {
+      k = src->clip - src->fill;
+    } else {
+      k = src->rowBytes - src->fill; // Clipped bytes are read and dropped
+      if (k > (int)sizeof skip)
+        k = sizeof skip;
+    }
+    if (k > n)
+      k = n;
+    uint8_t *dst = (src->fill < src->clip) ? &src->rows[src->next][src->fill]
+                                           : skip;
+    if (wait) {
+      got = src->stream->readBytes(dst, k);
+    } else {
+      int a = src->stream->available();
+      if (a <= 0)
+        return true;
+      got = src->stream->readBytes(dst, (a < k) ? a : k);
+    }
+    src->fill += got;
+    n -= got;
+    if (got < k)
+      return !wait;
+  }
+  return true;
+}
+
+static const uint8_t *getStreamRow(void *ctx, int, uint8_t *, uint8_t) {
+  BitmapStreamSource *src = (BitmapStreamSource *)ctx;
+  if (src->failed || (src->rowsLeft <= 0) ||
+      !readStreamRow(src, src->rowBytes - src->fill, true)) {
+    src->failed = true;
+    return NULL;
+  }
+  const uint8_t *row = src->rows[src->next];
+  src->next ^= 1;
+  src->fill = 0;
+  src->rowsLeft--;
+  return row;
+}
+
+static bool getStreamPrefetch(void *ctx) {
+  BitmapStreamSource *src = (BitmapStreamSource *)ctx;
+  if (src->failed || (src->rowsLeft <= 0) || (src->fill >= src->rowBytes))
+    return false; // Nothing to read ahead (or no more of this image)
+  readStreamRow(src, src->rowBytes - src->fill, false);
+  return src->fill < src->rowBytes;
+}
+
+// Bytes of a row up to and including its last non-blank byte; 0 if blank.
+static uint8_t inkWidth(const uint8_t *row, uint8_t n) {
+  while (n && !row[n - 1])
+    n--;
+  return n;
+}
+
+// Black dots in a row, for density timing.
+static uint16_t inkDots(const uint8_t *row, uint8_t n) {
+  static const uint8_t PROGMEM nibbleDots[16] = {0, 1, 1, 2, 1, 2, 2, 3,
+                                                 1, 2, 2, 3, 2, 3, 3, 4};
+  uint16_t dots = 0;
+  while (n--) {
+    dots += pgm_read_byte(&nibbleDots[*row & 0x0F]) +
+            pgm_read_byte(&nibbleDots[*row >> 4]);
+    row++;
+  }
+  return dots;
+}
+
+// Blank rows within a bitmap (common around logos and QR codes) are not
+// printed; the paper is fed past them with ESC J, which is far quicker
+// than heating a line of nothing.  Runs at the start of a chunk are
+// always fed.  With a seekable source, chunks are also ended early where
+// a run of at least BLANK_RUN_MIN blank rows begins, and when the text is
+// left-justified each chunk's blank right margin is left off too.  (The
+// left margin can't be trimmed: the raster commands have no x offset.)
+#define BLANK_RUN_MIN 4
+
+// Feeds past rows of blank bitmap, paced like bitmap rows.
+void Adafruit_Thermal::feedBlankRows(int rows) {
+  uint8_t cmd[3] = {ASCII_ESC, 'J', 0};
+  while (rows > 0) {
+    cmd[2] = (rows > 255) ? 255 : rows;
+    rows -= cmd[2];
+    waitCredit(sizeof cmd);
+    sendBytes(cmd, sizeof cmd);
+    timeoutExtend(cmd[2] * dotFeedTime + sizeof cmd * BYTE_TIME);
+  }
+}
+
+// Common chunk loop behind all of the printBitmap() variants.
+bool Adafruit_Thermal::printBitmapRows(int w, int h, BitmapRowSource getRow,
+                                       void *ctx, bool seekable,
+                                       BitmapPrefetch prefetch) {
+  int rowBytes, rowBytesClipped, chunkHeight, chunkHeightLimit, blank, y, n;
+  uint8_t buf[48], header[8], headerLen, width, ink;
+  const uint8_t *row = NULL;
+  bool ended = false;
+  unsigned long start, rowTime, sendTime;
+  bool raster = (firmware >= FIRMWARE_ESCPOS);
 
   rowBytes = (w + 7) / 8; // Round up to next byte boundary
   rowBytesClipped = (rowBytes >= 48) ? 48 : rowBytes; // 384 pixels max width
 
-  // Est. max rows to write at once, assuming 256 byte printer buffer.
+  // Two raster backends share the chunk loop below.  Older firmware only
+  // has DC2 * r n, limited to 255 rows per command.  Full ESC/POS
+  // firmware takes GS v 0 m xL xH yL yH with a 16-bit height, so tall
+  // images need far fewer command frames.
+  if (raster) {
+    header[0] = ASCII_GS;
+    header[1] = 'v';
+    header[2] = '0';
+    header[3] = 0; // Normal (not double width/height) mode
+    header[5] = 0;
+    headerLen = 8;
+  } else {
+    header[0] = ASCII_DC2;
+    header[1] = '*';
+    headerLen = 4;
+  }
+
+  // A row takes its print time or its transfer time, whichever is longer
+  rowTime = sendTime = rowBytesClipped * BYTE_TIME;
+  if (rowTime < dotPrintTime)
+    rowTime = dotPrintTime;
+  // (with density timing, the print time is worked out per row below)
+
+  // Max rows to write at once.  DC2 * chunks are kept small enough to fit
+  // the printer buffer; GS v 0 printers take rows as they arrive, so the
+  // flow control alone keeps their buffer from overrunning.
   if (dtrEnabled) {
-    chunkHeightLimit = 255; // Buffer doesn't matter, handshake!
+    chunkHeightLimit = raster ? h : 255; // Buffer doesn't matter, handshake!
   } else {
-    chunkHeightLimit = 256 / rowBytesClipped;
+    chunkHeightLimit = raster ? maxChunkHeight : bufferSize / rowBytesClipped;
     if (chunkHeightLimit > maxChunkHeight)
       chunkHeightLimit = maxChunkHeight;
-    else if (chunkHeightLimit < 1)
-      chunkHeightLimit = 1;
+    if (!raster && (chunkHeightLimit > 255))
+      chunkHeightLimit = 255; // DC2 * r is a single byte
   }
+  if (chunkHeightLimit < 1)
+    chunkHeightLimit = 1;
+
+  flushStyle();
+  commitBytes(); // Anything staged before the bitmap isn't bitmap traffic
+  STATS_KIND(STATS_BITMAP);
+
+  for (y = 0; y < h; y += chunkHeight) {
+    // Feed past any blank rows
+    for (blank = 0; y < h; y++, blank++) {
+      if (!(row = getRow(ctx, y, buf, rowBytesClipped)))
+        ended = true;
+      if (ended || inkWidth(row, rowBytesClipped))
+        break;
+    }
+    feedBlankRows(blank);
+    if ((y >= h) || ended)
+      break;
 
-  for (i = rowStart = 0; rowStart < h; rowStart += chunkHeightLimit) {
     // Issue up to chunkHeightLimit rows at a time:
-    chunkHeight = h - rowStart;
+    chunkHeight = h - y;
     if (chunkHeight > chunkHeightLimit)
       chunkHeight = chunkHeightLimit;
+    width = rowBytesClipped;
+
+    if (seekable) { // Look ahead for a blank run and the chunk's ink width
+      int last = 0;
+      width = 0;
+      for (n = 0, blank = 0; n < chunkHeight; n++) {
+        if ((ink = inkWidth(getRow(ctx, y + n, buf, rowBytesClipped),
+                            rowBytesClipped))) {
+          last = n + 1;
+          blank = 0;
+          if (ink > width)
+            width = ink;
+        } else if (++blank >= BLANK_RUN_MIN) {
+          break;
+        }
+      }
+      chunkHeight = last;
+      if (justification)
+        width = rowBytesClipped; // Trimming would shift the image over
+    }
 
-    writeBytes(ASCII_DC2, '*', chunkHeight, rowBytesClipped);
-
-    for (y = 0; y < chunkHeight; y++) {
-      for (x = 0; x < rowBytesClipped; x++, i++) {
-        timeoutWait();
-        stream->write(fromProgMem ? pgm_read_byte(bitmap + i) : *(bitmap + i));
+    // Each chunk (header, then rows) goes out as fast as the printer's
+    // buffer drains, so printing continues across chunk boundaries.
+    if (raster) {
+      header[4] = width;
+      header[6] = chunkHeight;
+      header[7] = chunkHeight >> 8;
+    } else {
+      header[2] = chunkHeight;
+      header[3] = width;
+    }
+    waitCredit(headerLen);
+    sendBytes(header, headerLen);
+    timeoutExtend(headerLen * BYTE_TIME);
+    start = micros();
+
+    learnPasses = 0;
+    for (n = 0; n < chunkHeight; n++) {
+      if ((seekable || n) && !ended &&
+          !(row = getRow(ctx, y + n, buf, rowBytesClipped))) {
+        ended = true;
+        memset(buf, 0, width);
+      }
+      if (ended)
+        row = buf;
+      if (prefetch && !jobBuf) { // Read ahead while the printer is busy
+        while (!creditReady(width) && prefetch(ctx))
+          yield();
       }
-      i += rowBytes - rowBytesClipped;
+      waitCredit(width);
+      sendBytes(row, width);
+      if (densityTiming) {
+        uint16_t dots = inkDots(row, width);
+        unsigned long t = rowPrintTime(dots);
+        learnPasses += heatPasses(dots);
+        timeoutExtend((t > sendTime) ? t : sendTime);
+      } else {
+        timeoutExtend(rowTime);
+      }
+    }
+    // Learn from this chunk only if printing, not serial, set the pace
+    // (and it's short enough to count in learnRows)
+    if (dtrEnabled && (chunkHeight <= 255) &&
+        ((unsigned long)(2 * rowBytesClipped * BYTE_TIME) < dotPrintTime)) {
+      learnStart = start;
+      learnRows = chunkHeight;
+      learnFeed = false;
     }
-    timeoutSet(chunkHeight * dotPrintTime);
+    if (ended)
+      break;
   }
-  prevByte = '\n';
+  STATS_KIND(STATS_COMMAND);
+  lineDots = lineHeight = 0;
+  return !ended;
 }
 
-void Adafruit_Thermal::printBitmap(int w, int h, Stream *fromStream) {
-  int rowBytes, rowBytesClipped, rowStart, chunkHeight, chunkHeightLimit, x, y,
-      i, c;
+void Adafruit_Thermal::printBitmap(int w, int h, const uint8_t *bitmap,
+                                   bool fromProgMem) {
+  BitmapArraySource src = {bitmap, (w + 7) / 8, fromProgMem};
+  printBitmapRows(w, h, getArrayRow, &src, true);
+}
 
-  rowBytes = (w + 7) / 8; // Round up to next byte boundary
-  rowBytesClipped = (rowBytes >= 48) ? 48 : rowBytes; // 384 pixels max width
+bool Adafruit_Thermal::printBitmap(int w, int h, Stream *fromStream) {
+  BitmapStreamSource src;
+  src.stream = fromStream;
+  src.rowBytes = (w + 7) / 8;
+  src.clip = (src.rowBytes >= 48) ? 48 : src.rowBytes;
+  src.rowsLeft = h;
+  src.fill = src.next = 0;
+  src.failed = false;
+  return printBitmapRows(w, h, getStreamRow, &src, false, getStreamPrefetch);
+}
 
-  // Est. max rows to write at once, assuming 256 byte printer buffer.
-  if (dtrEnabled) {
-    chunkHeightLimit = 255; // Buffer doesn't matter, handshake!
+bool Adafruit_Thermal::printBitmap(Stream *fromStream) {
+  uint8_t size[4];
+
+  if (fromStream->readBytes(size, 4) < 4)
+    return false;
+  return printBitmap(size[0] | (size[1] << 8), size[2] | (size[3] << 8),
+                     fromStream);
+}
+
+// Image files are decoded as they're read, a row at a time, so artwork
+// can be copied to an SD card and printed without converting it first.
+// A binary PBM (P4) stores rows top to bottom, MSB first, 1 = black,
+// padded to whole bytes: exactly the printer's own raster format, so
+// after its text header it goes through the stream path above.  A 1-bit
+// BMP pads each row to a multiple of four bytes, its pixels index a
+// two-color palette, and it's usually stored bottom row first; each row
+// is found by seeking to it, which costs the SD library little since
+// neighbouring rows share a sector.
+
+//! Row source state for 1-bit BMP files
+struct BitmapFileSource {
+  Stream *file;                     //!< The open BMP file
+  bool (*seek)(Stream *, uint32_t); //!< Moves the file to a byte offset
+  uint32_t offset;                  //!< Offset of the first stored row
+  uint32_t stride;                  //!< Bytes per stored row, padded
+  int h;                            //!< Height of the image in pixels
+  int y;                            //!< Next row to print
+  bool bottomUp;                    //!< True if stored last row first
+  uint8_t invert;                   //!< 0xFF if palette entry 0 is dark
+  uint8_t lastMask;                 //!< Pixels kept in the last byte
+  uint8_t clip;                     //!< Bytes sent per row
+  uint8_t row[48];                  //!< The row being sent
+};
+
+static const uint8_t *getFileRow(void *ctx, int, uint8_t *, uint8_t n) {
+  BitmapFileSource *src = (BitmapFileSource *)ctx;
+  int r = src->bottomUp ? src->h - 1 - src->y : src->y;
+  src->y++;
+  if (!src->seek(src->file, src->offset + (uint32_t)r * src->stride) ||
+      (src->file->readBytes(src->row, n) < n))
+    return NULL;
+  if (src->invert) {
+    for (uint8_t i = 0; i < n; i++)
+      src->row[i] ^= 0xFF;
+    src->row[n - 1] &= src->lastMask; // Keep padding white
+  }
+  return src->row;
+}
+
+// Reads an n-byte little-endian value; returns false if the file is short.
+static bool readLE(Stream *s, uint8_t n, uint32_t *v) {
+  uint8_t b[4];
+  if (s->readBytes(b, n) < n)
+    return false;
+  *v = 0;
+  while (n--)
+    *v = (*v << 8) | b[n];
+  return true;
+}
+
+bool Adafruit_Thermal::printBMPFile(Stream *file, FileSeek seek) {
+  uint32_t magic, offset, infoSize, w, h, planesBits, compression;
+  uint8_t palette[8];
+
+  // BITMAPFILEHEADER, then the start of BITMAPINFOHEADER (or a later
+  // version, which only adds fields after these)
+  if (!seek(file, 0) || !readLE(file, 2, &magic) || (magic != 0x4D42) ||
+      !seek(file, 10) || !readLE(file, 4, &offset) ||
+      !readLE(file, 4, &infoSize) || (infoSize < 40) ||
+      !readLE(file, 4, &w) || !readLE(file, 4, &h) ||
+      !readLE(file, 4, &planesBits) || !readLE(file, 4, &compression))
+    return false;
+  if ((planesBits != 0x00010001UL) || compression) // 1 plane of 1 bit, BI_RGB
+    return false;
+  // The two palette entries (blue, green, red, reserved) follow the header
+  if (!seek(file, 14 + infoSize) || (file->readBytes(palette, 8) < 8))
+    return false;
+
+  BitmapFileSource src;
+  int32_t height = (int32_t)h;
+  if (!w || (w > 0x7FFF) || !height || (height < -0x7FFF) ||
+      (height > 0x7FFF))
+    return false;
+  src.file = file;
+  src.seek = seek;
+  src.offset = offset;
+  src.stride = ((w + 31) / 32) * 4;
+  src.bottomUp = (height > 0);
+  src.h = src.bottomUp ? height : -height;
+  src.y = 0;
+  src.clip = (w >= 384) ? 48 : (w + 7) / 8;
+  src.lastMask = ((w < 384) && (w & 7)) ? 0xFF << (8 - (w & 7)) : 0xFF;
+  // Printed bits are 1 = black, so invert if entry 1 is the lighter one
+  src.invert = ((palette[0] + palette[1] + palette[2]) <
+                (palette[4] + palette[5] + palette[6]))
+                   ? 0xFF
+                   : 0;
+  return printBitmapRows(w, src.h, getFileRow, &src, false);
+}
+
+// Next whitespace-separated number in a PNM header, skipping comments.
+// Returns -1 if the stream ends or times out first.
+static long readPnmNumber(Stream *s) {
+  long v = -1;
+  uint8_t c;
+  bool comment = false;
+  while (s->readBytes(&c, 1) == 1) {
+    if (comment) {
+      comment = (c != '\n') && (c != '\r');
+      if (!comment && (v >= 0))
+        return v; // A comment's line end also ends the number before it
+    } else if (c == '#') {
+      comment = true;
+    } else if ((c >= '0') && (c <= '9')) {
+      v = ((v < 0) ? 0 : v * 10) + (c - '0');
+      if (v > 0x7FFF)
+        return -1;
+    } else if (v >= 0) {
+      return v; // Ends at (and consumes) one whitespace byte
+    } else if ((c != ' ') && (c != '\t') && (c != '\n') && (c != '\r')) {
+      return -1;
+    }
+  }
+  return -1;
+}
+
+bool Adafruit_Thermal::printPBM(Stream *fromStream) {
+  uint8_t magic[2];
+  long w, h;
+
+  if ((fromStream->readBytes(magic, 2) < 2) || (magic[0] != 'P') ||
+      (magic[1] != '4') || ((w = readPnmNumber(fromStream)) <= 0) ||
+      ((h = readPnmNumber(fromStream)) <= 0))
+    return false;
+  return printBitmap(w, h, fromStream);
+}
+
+// Transformed bitmaps are generated a row at a time from an array image,
+// so every variant of a label or logo can be printed from one copy in
+// flash.  Mirroring reads each output byte's pixels as a window of the
+// source row and bit-reverses it; rotation gathers one bit column from
+// eight source rows at a time (a row of an 8x8 bit transpose).  On
+// 32-bit parts these kernels work on whole words; AVR uses byte-sized
+// table lookups and shifts instead.
+
+#if defined(__AVR__)
+typedef uint8_t BitWord; //!< Word size for the bitmap kernels
+#else
+typedef uint32_t BitWord; //!< Word size for the bitmap kernels
+#endif
+#define BITWORD_BYTES ((int)sizeof(BitWord)) //!< Bytes per BitWord
+
+//! Row source state for printBitmapTransformed()
+struct BitmapTransformSource {
+  const uint8_t *bitmap; //!< Start of the image
+  int w;                 //!< Stored image width in pixels
+  int h;                 //!< Stored image height in pixels
+  int rowBytes;          //!< Bytes per stored row
+  uint8_t transform;     //!< BITMAP_* flags
+  bool fromProgMem;      //!< True if bitmap is in flash
+};
+
+// Byte i of stored row y, or 0 outside the image.
+static uint8_t bitmapByte(const BitmapTransformSource *src, int y, int i) {
+  if ((y < 0) || (y >= src->h) || (i < 0) || (i >= src->rowBytes))
+    return 0;
+  const uint8_t *p = src->bitmap + (long)y * src->rowBytes + i;
+  return src->fromProgMem ? pgm_read_byte(p) : *p;
+}
+
+// Reverses the bit order of a word.
+static BitWord reverseBits(BitWord v) {
+#if defined(__AVR__)
+  static const uint8_t PROGMEM nibbleReverse[16] = {
+      0x0, 0x8, 0x4, 0xC, 0x2, 0xA, 0x6, 0xE,
+      0x1, 0x9, 0x5, 0xD, 0x3, 0xB, 0x7, 0xF};
+  return (pgm_read_byte(&nibbleReverse[v & 0x0F]) << 4) |
+         pgm_read_byte(&nibbleReverse[v >> 4]);
+#else
+  v = ((v >> 1) & 0x55555555UL) | ((v & 0x55555555UL) << 1);
+  v = ((v >> 2) & 0x33333333UL) | ((v & 0x33333333UL) << 2);
+  v = ((v >> 4) & 0x0F0F0F0FUL) | ((v & 0x0F0F0F0FUL) << 4);
+  v = ((v >> 8) & 0x00FF00FFUL) | ((v & 0x00FF00FFUL) << 8);
+  return (v >> 16) | (v << 16);
+#endif
+}
+
+// Pixels q onward of stored row y as a word, first pixel in the MSB.
+static BitWord pixelWord(const BitmapTransformSource *src, int y, int q) {
+  int i = (q < 0) ? -((7 - q) / 8) : q / 8; // Byte holding pixel q
+  uint8_t shift = q - i * 8;
+  BitWord v = 0;
+  for (int k = 0; k < BITWORD_BYTES; k++)
+    v = (v << 8) | bitmapByte(src, y, i + k);
+  if (shift)
+    v = (v << shift) | (bitmapByte(src, y, i + BITWORD_BYTES) >> (8 - shift));
+  return v;
+}
+
+// Bit 'shift' of each of eight bytes, first byte in the MSB.
+static uint8_t gatherBits(const uint8_t *b, uint8_t shift) {
+#if defined(__AVR__)
+  uint8_t out = 0;
+  for (uint8_t k = 0; k < 8; k++)
+    out = (out << 1) | ((b[k] >> shift) & 1);
+  return out;
+#else
+  // Mask one bit per byte, then a multiply shifts all four up next to
+  // each other in the top byte without any carries.
+  uint32_t hi = ((uint32_t)b[0] << 24) | ((uint32_t)b[1] << 16) |
+                ((uint32_t)b[2] << 8) | b[3],
+           lo = ((uint32_t)b[4] << 24) | ((uint32_t)b[5] << 16) |
+                ((uint32_t)b[6] << 8) | b[7];
+  hi = (((hi >> shift) & 0x01010101UL) * 0x01020408UL) >> 24;
+  lo = (((lo >> shift) & 0x01010101UL) * 0x01020408UL) >> 24;
+  return ((hi & 0x0F) << 4) | (lo & 0x0F);
+#endif
+}
+
+static const uint8_t *getTransformRow(void *ctx, int y, uint8_t *buf,
+                                      uint8_t n) {
+  BitmapTransformSource *src = (BitmapTransformSource *)ctx;
+  uint8_t t = src->transform, i, k;
+  int width;
+
+  if (t & BITMAP_ROTATE) { // Row y is column y (or w-1-y) of the stored image
+    int x = (t & BITMAP_FLIP) ? src->w - 1 - y : y;
+    uint8_t col[8];
+    width = src->h;
+    for (i = 0; i < n; i++) {
+      for (k = 0; k < 8; k++) {
+        int r = i * 8 + k;
+        col[k] = bitmapByte(src, (t & BITMAP_MIRROR) ? r : src->h - 1 - r,
+                            x >> 3);
+      }
+      buf[i] = gatherBits(col, 7 - (x & 7));
+    }
   } else {
-    chunkHeightLimit = 256 / rowBytesClipped;
-    if (chunkHeightLimit > maxChunkHeight)
-      chunkHeightLimit = maxChunkHeight;
-    else if (chunkHeightLimit < 1)
-      chunkHeightLimit = 1;
+    int r = (t & BITMAP_FLIP) ? src->h - 1 - y : y;
+    width = src->w;
+    if (t & BITMAP_MIRROR) { // Output byte i ends at pixel w-1-8i
+      for (i = 0; i < n; i += BITWORD_BYTES) {
+        BitWord v = reverseBits(
+            pixelWord(src, r, src->w - i * 8 - BITWORD_BYTES * 8));
+        for (k = 0; (k < BITWORD_BYTES) && (i + k < n); k++)
+          buf[i + k] = v >> ((BITWORD_BYTES - 1 - k) * 8);
+      }
+    } else {
+      for (i = 0; i < n; i++)
+        buf[i] = bitmapByte(src, r, i);
+    }
   }
 
-  for (rowStart = 0; rowStart < h; rowStart += chunkHeightLimit) {
-    // Issue up to chunkHeightLimit rows at a time:
-    chunkHeight = h - rowStart;
-    if (chunkHeight > chunkHeightLimit)
-      chunkHeight = chunkHeightLimit;
+  if (t & BITMAP_INVERT) {
+    for (i = 0; i < n; i++)
+      buf[i] ^= 0xFF;
+    if ((width & 7) && (((width - 1) >> 3) < n)) // Keep padding white
+      buf[(width - 1) >> 3] &= 0xFF << (8 - (width & 7));
+  }
+  return buf;
+}
+
+void Adafruit_Thermal::printBitmapTransformed(int w, int h,
+                                              const uint8_t *bitmap,
+                                              uint8_t transform,
+                                              bool fromProgMem) {
+  BitmapTransformSource src = {bitmap,    w,          h, (w + 7) / 8,
+                               transform, fromProgMem};
+  if (transform & BITMAP_ROTATE)
+    printBitmapRows(h, w, getTransformRow, &src, true);
+  else
+    printBitmapRows(w, h, getTransformRow, &src, true);
+}
 
-    writeBytes(ASCII_DC2, '*', chunkHeight, rowBytesClipped);
+// Compressed bitmaps, as written by image_to_file.py --compress or
+// image_to_bytes --compress: each row is XORed with the row above it
+// (the first with all zeros) and the whole delta stream is then PackBits
+// encoded.  A header byte n of 0-127 is followed by n+1 literal bytes; a
+// header of 129-255 is followed by one byte to repeat 257-n times (128 is
+// a no-op).  Runs may cross row boundaries.  Rows are unpacked one at a
+// time into a 48-byte scratch line, which also serves as the reference
+// for the next row's delta, so no full-frame buffer is needed.  Reads
+// stop at the end of the data, so a truncated or corrupt image can't run
+// past it; a row left unfinished ends the image, as a timeout does with
+// a stream.
+
+//! Decoder state for bitmaps in the compressed format
+struct BitmapPackedSource {
+  const uint8_t *data; //!< Next compressed byte
+  const uint8_t *end;  //!< Just past the last compressed byte
+  int rowBytes;        //!< Full (unclipped) bytes per row
+  bool fromProgMem;    //!< True if data is in flash
+  bool repeat;         //!< True if the current run repeats 'value'
+  bool ended;          //!< True once a read went past the end
+  uint8_t count;       //!< Bytes left in the current run
+  uint8_t value;       //!< Byte being repeated
+  uint8_t line[48];    //!< Current row (clipped)
+};
+
+static uint8_t packedByte(BitmapPackedSource *src) {
+  if (src->data >= src->end) {
+    src->ended = true;
+    return 0;
+  }
+  return src->fromProgMem ? pgm_read_byte(src->data++) : *src->data++;
+}
 
-    for (y = 0; y < chunkHeight; y++) {
-      for (x = 0; x < rowBytesClipped; x++) {
-        while ((c = fromStream->read()) < 0)
-          ;
-        timeoutWait();
-        stream->write((uint8_t)c);
+static uint8_t unpackByte(BitmapPackedSource *src) {
+  while (!src->count && !src->ended) {
+    uint8_t n = packedByte(src);
+    if (n < 128) {
+      src->count = n + 1;
+      src->repeat = false;
+    } else if (n > 128) {
+      src->count = 257 - n;
+      src->repeat = true;
+      src->value = packedByte(src);
+    }
+  }
+  if (src->ended)
+    return 0;
+  src->count--;
+  return src->repeat ? src->value : packedByte(src);
+}
+
+static const uint8_t *getPackedRow(void *ctx, int, uint8_t *, uint8_t n) {
+  BitmapPackedSource *src = (BitmapPackedSource *)ctx;
+  for (int x = 0; x < src->rowBytes; x++) {
+    uint8_t delta = unpackByte(src);
+    if (x < n)
+      src->line[x] ^= delta;
+  }
+  return src->ended ? NULL : src->line;
+}
+
+bool Adafruit_Thermal::printBitmapCompressed(int w, int h, const uint8_t *data,
+                                             size_t len, bool fromProgMem) {
+  BitmapPackedSource src;
+  src.data = data;
+  src.end = data + len;
+  src.rowBytes = (w + 7) / 8;
+  src.fromProgMem = fromProgMem;
+  src.ended = false;
+  src.count = 0;
+  memset(src.line, 0, sizeof src.line);
+  return printBitmapRows(w, h, getPackedRow, &src, false);
+}
+
+// Grayscale images are dithered on the fly, a row at a time, as they're
+// read from the stream.  Images wider than the print head are first
+// shrunk by an integer factor, either averaging each scale x scale block
+// (box filter) or taking its top-left pixel (nearest).  Error diffusion
+// keeps a single line of pending error, holding the below-right share in
+// a variable until that pixel has been read.  Box scaling and diffusion
+// each need a line of 16-bit values from the heap; if that allocation
+// fails printing carries on with nearest sampling and ordered dither,
+// which need no storage beyond the 48-byte output row.
+
+//! Row source state for printGrayscale()
+struct BitmapGraySource {
+  Stream *stream;   //!< Where the pixels come from
+  int srcWidth;     //!< Source pixels per row
+  int width;        //!< Scaled pixels per row (384 max)
+  uint8_t scale;    //!< Source rows and columns per output pixel
+  uint8_t dither;   //!< DITHER_* method
+  uint16_t *sum;    //!< Box filter totals, or NULL for nearest
+  int16_t *err;     //!< Diffused error for the next row, or NULL
+  int16_t carry;    //!< Error carried to the right (7/16)
+  int16_t diagonal; //!< Error pending for below-right (1/16)
+  bool failed;      //!< True once a read has timed out
+};
+
+// 4x4 Bayer matrix, as thresholds in the middle of each 16-level step
+static const uint8_t PROGMEM bayer[16] = {
+    8, 136, 40, 168, 200, 72, 232, 104, 56, 184, 24, 152, 248, 120, 216, 88};
+
+// Reads one pixel, giving up after the stream's timeout like readBytes().
+static bool readPixel(Stream *stream, uint8_t *g) {
+  return stream->readBytes(g, 1) == 1;
+}
+
+// Dithers one scaled pixel into the output row; true if it prints black.
+static bool ditherPixel(BitmapGraySource *src, int x, int y, int16_t g) {
+  switch (src->dither) {
+  case DITHER_ORDERED:
+    return g < pgm_read_byte(&bayer[((y & 3) << 2) | (x & 3)]);
+  case DITHER_DIFFUSE:
+    if (src->err) {
+      int16_t e;
+      bool black;
+      g += src->err[x] + src->carry;
+      black = (g < 128);
+      e = black ? g : g - 255;
+      src->carry = e * 7 / 16;
+      if (x)
+        src->err[x - 1] += e * 3 / 16;
+      src->err[x] = e * 5 / 16 + src->diagonal;
+      src->diagonal = e / 16;
+      return black;
+    }
+    return g < pgm_read_byte(&bayer[((y & 3) << 2) | (x & 3)]);
+  default:
+    return g < 128;
+  }
+}
+
+static const uint8_t *getGrayRow(void *ctx, int y, uint8_t *buf, uint8_t n) {
+  BitmapGraySource *src = (BitmapGraySource *)ctx;
+  int x, ox, r;
+  uint8_t sub, g;
+
+  if (src->failed)
+    return NULL;
+  memset(buf, 0, n);
+  src->carry = src->diagonal = 0;
+  if (src->sum)
+    memset(src->sum, 0, src->width * sizeof src->sum[0]);
+
+  for (r = 0; r < src->scale; r++) {
+    for (x = ox = sub = 0; x < src->srcWidth; x++) {
+      if (!readPixel(src->stream, &g)) {
+        src->failed = true; // Ends the image, as getStreamRow() does
+        return NULL;
+      }
+      if (ox < src->width) {
+        if (src->sum) {
+          src->sum[ox] += g;
+        } else if (!r && !sub && ditherPixel(src, ox, y, g)) {
+          buf[ox >> 3] |= 0x80 >> (ox & 7);
+        }
       }
-      for (i = rowBytes - rowBytesClipped; i > 0; i--) {
-        while ((c = fromStream->read()) < 0)
-          ;
+      if (++sub >= src->scale) {
+        sub = 0;
+        ox++;
       }
     }
-    timeoutSet(chunkHeight * dotPrintTime);
   }
-  prevByte = '\n';
+
+  if (src->sum) {
+    uint16_t area = src->scale * src->scale;
+    for (ox = 0; ox < src->width; ox++) {
+      if (ditherPixel(src, ox, y, src->sum[ox] / area))
+        buf[ox >> 3] |= 0x80 >> (ox & 7);
+    }
+  }
+  return buf;
 }
 
-void Adafruit_Thermal::printBitmap(Stream *fromStream) {
-  uint8_t tmp;
-  uint16_t width, height;
+bool Adafruit_Thermal::printGrayscale(int w, int h, Stream *fromStream,
+                                      uint8_t mode) {
+  BitmapGraySource src;
+  int scale, y;
+  bool ok;
+
+  scale = (w + 383) / 384;
+  if (scale > 255)
+    return false;
+  src.stream = fromStream;
+  src.srcWidth = w;
+  src.width = w / scale;
+  src.scale = scale;
+  src.dither = mode & ~SCALE_NEAREST;
+  src.sum = NULL;
+  src.err = NULL;
+  src.failed = false;
+  // 16-bit totals hold a box of up to 16x16 pixels
+  if ((scale > 1) && (scale <= 16) && !(mode & SCALE_NEAREST))
+    src.sum = (uint16_t *)malloc(src.width * sizeof src.sum[0]);
+  if (src.dither == DITHER_DIFFUSE) {
+    src.err = (int16_t *)calloc(src.width, sizeof src.err[0]);
+    if (!src.err) { // Not enough RAM, fall back to the cheap path
+      free(src.sum);
+      src.sum = NULL;
+    }
+  }
 
-  tmp = fromStream->read();
-  width = (fromStream->read() << 8) + tmp;
+  ok = printBitmapRows(src.width, h / scale, getGrayRow, &src, false);
+  for (y = (h / scale) * scale; ok && (y < h); y++) { // Discard leftovers
+    uint8_t skip[16];
+    for (int x = 0; ok && (x < w); x += sizeof skip) {
+      size_t k = ((w - x) < (int)sizeof skip) ? (w - x) : sizeof skip;
+      ok = (fromStream->readBytes(skip, k) == k);
+    }
+  }
 
-  tmp = fromStream->read();
-  height = (fromStream->read() << 8) + tmp;
+  free(src.sum);
+  free(src.err);
+  return ok;
+}
 
-  printBitmap(width, height, fromStream);
+// User-defined characters are uploaded as one ESC & frame: header, then
+// each glyph's width byte and column data straight from the caller's
+// array.  With THERMAL_GLYPH_CACHE, a 16-bit fingerprint of each loaded
+// glyph is kept per code, and the frame only spans the first to the
+// last glyph that isn't already on the printer (unchanged ones in
+// between ride along, which is cheaper than a header per run).  Loading
+// the same icon font before every receipt then costs nothing at all.
+// The record is forgotten by invalidateState(), since ESC @ and power
+// cycles both clear the printer's glyphs.
+
+#if THERMAL_GLYPH_CACHE
+// Fingerprint (FNV-1a, folded to 16 bits) of a glyph's height and data.
+static uint16_t glyphTag(uint8_t y_bytes, const uint8_t *p, uint16_t n) {
+  uint32_t h = 2166136261UL ^ y_bytes;
+  while (n--)
+    h = (h ^ *p++) * 16777619UL;
+  uint16_t t = (h >> 16) ^ h;
+  return t ? t : 1; // 0 means nothing is known
 }
+#endif
 
-// Defines one or multiple custom characters in sequence 
+// Defines one or multiple custom characters in sequence
 void Adafruit_Thermal::userDefinedCharacter(uint8_t y_bytes, uint8_t charCodeFrom, uint8_t charCodeTo, int arySize, const uint8_t *charBytes) {
   // (ESC, '&', 3, 32, 32, [Charwidth, 3xCharwidth bytes],[Charwidth, 3xCharwidth bytes],etc... ) See new examples folder
+  int first = -1, last = -1, from = 0, to = 0;
 
-  writeBytes(ASCII_ESC, '&',y_bytes, charCodeFrom, charCodeTo); // Initial command to define a character
-  
-  for (int x = 0; x < arySize; x++)  {
-    timeoutWait();
-    stream->write(charBytes[x]);
+  // Note each character's width for the layout (it leads its bitmap),
+  // and find the span of glyphs the printer doesn't have yet
+  for (int c = charCodeFrom, i = 0; c <= charCodeTo; c++) {
+    if (i >= arySize)
+      break;
+    uint8_t w = charBytes[i];
+    int n = 1 + y_bytes * w;
+    if (i + n > arySize)
+      break; // Incomplete glyph; the printer would wait for the rest
+    bool send = true;
+    if ((c >= 32) && (c < 128)) {
+      setUserWidth(c, w);
+#if THERMAL_GLYPH_CACHE
+      uint16_t tag = glyphTag(y_bytes, &charBytes[i], n);
+      send = (glyphTags[c - 32] != tag);
+      glyphTags[c - 32] = tag;
+#endif
+    }
+    if (send) {
+      if (first < 0) {
+        first = c;
+        from = i;
+      }
+      last = c;
+      to = i + n;
+    }
+    i += n;
   }
+  if (first < 0)
+    return; // All resident (or nothing to send)
+
+  flushWord(); // Text written before the glyphs goes first
+  commitBytes();
+  uint8_t header[5] = {ASCII_ESC, '&', y_bytes, (uint8_t)first, (uint8_t)last};
+  sendBlock(header, sizeof header);
+  sendBlock(&charBytes[from], to - from);
 }
 
 // Removes data from the user-defined character and reverts to standard character set.
 void Adafruit_Thermal::clearUserCharacter(uint8_t charVal) {
+  if ((charVal >= 32) && (charVal < 128)) {
+    setUserWidth(charVal, 0);
+#if THERMAL_GLYPH_CACHE
+    glyphTags[charVal - 32] = 0;
+#endif
+  }
   writeBytes(ASCII_ESC, '?', charVal);  
 }
 
 // Take the printer offline. Print commands sent after this will be
 // ignored until 'online' is called.
-void Adafruit_Thermal::offline() { writeBytes(ASCII_ESC, '=', 0); }
+void Adafruit_Thermal::offline() {
+  if (stateChanged(SHADOW_ONLINE, 0))
+    writeBytes(ASCII_ESC, '=', 0);
+}
 
 // Take the printer back online. Subsequent print commands will be obeyed.
-void Adafruit_Thermal::online() { writeBytes(ASCII_ESC, '=', 1); }
+void Adafruit_Thermal::online() {
+  if (stateChanged(SHADOW_ONLINE, 1))
+    writeBytes(ASCII_ESC, '=', 1);
+}
 
 // Put the printer into a low-energy state immediately.
 void Adafruit_Thermal::sleep() {
@@ -715,9 +3351,16 @@ void Adafruit_Thermal::sleepAfter(uint16_t seconds) {
 void Adafruit_Thermal::wake() {
   timeoutSet(0);   // Reset timeout counter
   writeBytes(255); // Wake
-  if (firmware >= 264) {
-    delay(50);
-    writeBytes(ASCII_ESC, '8', 0, 0); // Sleep off (important!)
+  if (jobShared() && (firmware >= 264)) {
+    timeoutSet(WAKE_TIMEOUT); // Only the print task may read the stream
+    writeCommand<CmdSleepOff>();
+  } else if (firmware >= 264) {
+    // Datasheet asks for a 50 mS pause, but a printer that answers a
+    // status request is awake already.
+    commitBytes(); // Wake byte must be on the wire before the pause
+    drain();
+    statusProbe(WAKE_TIMEOUT);
+    writeCommand<CmdSleepOff>(); // Important!
   } else {
     // Datasheet recommends a 50 mS delay before issuing further commands,
     // but in practice this alone isn't sufficient (e.g. text size/style
@@ -734,7 +3377,7 @@ void Adafruit_Thermal::wake() {
 // ability.  Returns true for paper, false for no paper.
 // Amended for DFRobot GY-EH402 Thermal printer paper status
 bool Adafruit_Thermal::hasPaper() {
-  uint8_t status = getStatus(4);
+  uint8_t status = getStatus(4); // From the ASB cache if that's on
   return !((status & 0b01100000) == 96);
 }
 
@@ -747,18 +3390,266 @@ bool Adafruit_Thermal::hasPaper() {
 // Page 3: Error cause status         (includes heat/voltage outside range flag)
 // Page 4: Paper Roll sensor status   (Paper Status)
 int Adafruit_Thermal::getStatus(uint8_t statusPage) {
-  writeCmdBytes('\x10', 4, statusPage, true);
-  uint8_t status = 255;  
-  for (uint8_t i = 0; i < 10; i++) {
-    if (stream->available()) {
-      status = stream->read();
-      break;
+  if (asbEnabled || jobShared()) {
+    // Replies are told apart from ASB bytes, so the input isn't flushed.
+    // With a print task, that task owns the stream and fetches the reply.
+    if (!jobShared())
+      pollStatus();
+    if ((!asbEnabled || (cachedStatus(statusPage) < 0)) &&
+        requestStatus(statusPage)) {
+      drain();
+      while (statusPending()) {
+        if (!jobShared())
+          pollStatus();
+        yield();
+      }
     }
-    delay(100);
+    int status = cachedStatus(statusPage);
+    return (status < 0) ? 255 : status;
+  }
+  drain();          // A queued requestStatus() goes out first...
+  statusWanted = 0; // ...but its reply would be discarded anyway
+  discardInput();   // A late reply to an earlier request isn't this one
+  writeCmdBytes(ASCII_DLE, 4, statusPage, true);
+  unsigned long start = millis();
+  while (!stream->available()) {
+    if (millis() - start >= STATUS_TIMEOUT)
+      return 255;
+    yield();
   }
+  uint8_t status = stream->read();
+  statusReply(statusPage, status);
   return status;
 }
 
+// === Asynchronous status ===
+// requestStatus() sends DLE EOT n and returns; poll() picks up the reply
+// byte when it arrives.  DLE EOT is a real-time command, answered as soon
+// as the printer receives it even with data waiting in its buffer, but it
+// must not land inside another command's bytes (a bitmap, say).  So with
+// data still in the job queue the request is queued as a JOB_STATUS
+// record, and poll() sends it when it gets there.  For the same reason
+// the status monitor only sends when the queue is empty.  The last reply
+// for each page is kept with the millis() time it arrived, and the
+// conditions decoded from pages 1, 2 and 4 are reported to the status
+// callback when they change.
+
+bool Adafruit_Thermal::requestStatus(uint8_t statusPage) {
+  if (statusWanted || (statusPage < 1) || (statusPage > 4))
+    return false;
+  if (onPrintTask()) {
+    // The status monitor, with the published commands all sent; staged
+    // bytes and the queue belong to the other task
+    statusWanted = statusPage;
+    sendStatusRequest();
+    return true;
+  }
+  commitBytes(); // Keep the request between whole commands
+  if (jobBuf && (composing || jobShared() || (jobTail != jobWr))) {
+    jobFlushExtend();
+    jobReserve(2);
+    jobPut(JOB_STATUS);
+    jobPut(statusPage);
+    jobOpen = jobDelay = jobCredit = JOB_NONE;
+    if (composing)
+      return true; // Made when the recording is replayed
+    statusQueued = true;
+  }
+  statusWanted = statusPage;
+  if (!statusQueued)
+    sendStatusRequest();
+  else if (jobShared())
+    jobPublish(true);
+  return true;
+}
+
+void Adafruit_Thermal::sendStatusRequest() {
+  discardInput();
+  stream->write(ASCII_DLE);
+  stream->write(4);
+  stream->write(statusWanted);
+  statusQueued = false;
+  statusAsked = millis();
+}
+
+bool Adafruit_Thermal::statusPending() { return statusWanted != 0; }
+
+int Adafruit_Thermal::cachedStatus(uint8_t statusPage) {
+  if ((statusPage < 1) || (statusPage > 4) ||
+      !(statusKnown & (1 << (statusPage - 1))))
+    return -1;
+  return statusBytes[statusPage - 1];
+}
+
+unsigned long Adafruit_Thermal::statusAge(uint8_t statusPage) {
+  if (cachedStatus(statusPage) < 0)
+    return 0xFFFFFFFFUL;
+  return millis() - statusStamp[statusPage - 1];
+}
+
+uint8_t Adafruit_Thermal::statusFlags() { return statusBits; }
+
+void Adafruit_Thermal::setStatusCallback(ThermalStatusCallback callback,
+                                         uint16_t interval) {
+  statusCallback = callback;
+  statusInterval = interval;
+  statusNext = 2;
+}
+
+// Called from poll(): collects a reply, expires a lost request, or sends
+// the next monitoring request.
+void Adafruit_Thermal::pollStatus() {
+  if (asbEnabled) {
+    while (stream->available()) {
+      uint8_t b = stream->read();
+      if ((b & 0x93) == 0x12) { // DLE EOT reply
+        if (statusWanted && !statusQueued) {
+          uint8_t page = statusWanted;
+          statusWanted = 0;
+          statusReply(page, b);
+        }
+      } else {
+        asbByte(b);
+      }
+    }
+  }
+  if (statusQueued) {
+    return; // Not sent yet
+  } else if (statusWanted) {
+    if (stream->available()) {
+      uint8_t page = statusWanted;
+      statusWanted = 0;
+      statusReply(page, stream->read());
+    } else if (millis() - statusAsked >= STATUS_TIMEOUT) {
+      statusWanted = 0; // No answer; the cache keeps the last one
+    }
+  } else if (statusInterval && !asbEnabled &&
+             (millis() - statusAsked >= statusInterval) &&
+             (!jobBuf ||
+              (!composing && (jobShared() ? ((jobTail == jobPub) && !jobCut)
+                                          : (jobTail == jobWr))))) {
+    if (requestStatus(statusNext)) // Alternate cover and paper checks
+      statusNext = (statusNext == 2) ? 4 : 2;
+  }
+}
+
+// Caches a status byte and reports any change in the decoded conditions.
+// Every DLE EOT reply has bits 1 and 4 set and bits 0 and 7 clear; other
+// bytes are noise on the line and are ignored.
+void Adafruit_Thermal::statusReply(uint8_t statusPage, uint8_t status) {
+  uint8_t flag, set;
+  if (((status & 0x93) != 0x12) || (statusPage < 1) || (statusPage > 4))
+    return;
+  statusBytes[statusPage - 1] = status;
+  statusStamp[statusPage - 1] = millis();
+  statusKnown |= 1 << (statusPage - 1);
+  switch (statusPage) {
+  case 1: // Printer status: bit 3 is offline
+    flag = STATUS_OFFLINE;
+    set = status & 0x08;
+    break;
+  case 2: // Offline cause: bit 2 is cover open
+    flag = STATUS_COVER_OPEN;
+    set = status & 0x04;
+    break;
+  case 4: // Roll paper sensor: bits 5-6 are paper end (as in hasPaper())
+    flag = STATUS_PAPER_OUT;
+    set = (status & 0x60) == 0x60;
+    break;
+  default:
+    return;
+  }
+  uint8_t bits = set ? (statusBits | flag) : (statusBits & ~flag);
+  if (bits != statusBits) {
+    statusBits = bits;
+    if (statusCallback)
+      statusCallback(bits);
+  }
+}
+
+// === Automatic status back ===
+// With ASB on (GS a n), the printer sends a 4-byte status block by itself
+// whenever the online, error or paper state changes, and once when it's
+// enabled.  The first byte of a block has bit 4 set and bits 0, 1 and 7
+// clear; the other three have bits 4 and 7 clear, and a DLE EOT reply
+// has bits 1 and 4 set, so the three kinds of byte can be told apart on
+// one line.  Each block is translated into the DLE EOT pages it covers
+// and cached like a reply to getStatus(), so hasPaper() and getStatus()
+// answer from the cache.  While the cached state says the printer can't
+// print (paper out or cover open), poll() sends nothing.
+
+void Adafruit_Thermal::autoStatusOn() {
+  asbEnabled = true;
+  asbCount = 0;
+  writeAsbMode();
+}
+
+void Adafruit_Thermal::autoStatusOff() {
+  asbEnabled = false;
+  writeAsbMode();
+}
+
+// DTR flow control and ASB are both set by GS a.
+void Adafruit_Thermal::writeAsbMode() {
+  writeBytes(ASCII_GS, 'a',
+             (dtrEnabled ? (1 << 5) : 0) | (asbEnabled ? ASB_BITS : 0));
+}
+
+void Adafruit_Thermal::asbByte(uint8_t b) {
+  if ((b & 0x93) == 0x10) {
+    asbBuf[0] = b; // Start of a block
+    asbCount = 1;
+  } else if (((b & 0x90) == 0) && asbCount && (asbCount < 4)) {
+    asbBuf[asbCount++] = b;
+    if (asbCount == 4) {
+      asbCount = 0;
+      // Byte 1: bit 3 offline, 5 cover open, 6 feed button; page 2
+      // has the cover in bit 2 and the button in bit 3
+      statusReply(1, 0x12 | (asbBuf[0] & 0x08));
+      statusReply(2, 0x12 | ((asbBuf[0] & 0x60) >> 3) |
+                         ((asbBuf[2] & 0x0C) ? 0x20 : 0) |
+                         ((asbBuf[1] & 0x6C) ? 0x40 : 0));
+      // Byte 2: error bits, in the same places as DLE EOT 3
+      statusReply(3, 0x12 | (asbBuf[1] & 0x6C));
+      // Byte 3: bits 0-1 paper near end, 2-3 paper end
+      statusReply(4, 0x12 | ((asbBuf[2] & 0x03) << 2) |
+                         ((asbBuf[2] & 0x0C) << 3));
+    }
+  } else {
+    asbCount = 0; // Noise or a lost byte; wait for the next block
+  }
+}
+
+// Requests printer status (DLE EOT 1) every PROBE_INTERVAL until the
+// printer answers or 'timeout' microseconds pass.  Returns true as soon
+// as it answers.  Requests sent while the printer was still asleep are
+// lost, so only one reply is expected; getStatus() drops any others.
+bool Adafruit_Thermal::statusProbe(unsigned long timeout) {
+  unsigned long start = micros();
+  statusWanted = 0;
+  discardInput();
+  for (;;) {
+    unsigned long sent = micros();
+    stream->write(ASCII_DLE);
+    stream->write(4);
+    stream->write(1);
+    while (micros() - sent < PROBE_INTERVAL) {
+      if (stream->available()) {
+        stream->read();
+        return true;
+      }
+      if (micros() - start >= timeout)
+        return false;
+      yield();
+    }
+  }
+}
+
+void Adafruit_Thermal::discardInput() {
+  while (stream->available())
+    stream->read();
+}
+
 void Adafruit_Thermal::setLineHeight(int val) {
   autoLineHeightOff();
   //Lowered minimum to allow to accomodatethe new smaller fonts
@@ -770,10 +3661,15 @@ void Adafruit_Thermal::setLineHeight(int val) {
   // when setting line height, making this more akin to inter-line
   // spacing.  Default line spacing is 30 (char height of 24, line
   // spacing of 6).
-  writeBytes(ASCII_ESC, '3', val);
+  if (stateChanged(SHADOW_LINE, val))
+    writeBytes(ASCII_ESC, '3', val);
 }
 
-void Adafruit_Thermal::setMaxChunkHeight(int val) { maxChunkHeight = val; }
+void Adafruit_Thermal::setMaxChunkHeight(int val) {
+  if (val < 1)
+    val = 1;
+  maxChunkHeight = val;
+}
 
 // These commands work only on printers w/recent firmware ------------------
 
@@ -781,20 +3677,19 @@ void Adafruit_Thermal::setMaxChunkHeight(int val) { maxChunkHeight = val; }
 void Adafruit_Thermal::setCharset(uint8_t val) {
   if (val > 15)
     val = 15;
-  writeBytes(ASCII_ESC, 'R', val);
+  if (stateChanged(SHADOW_CHARSET, val))
+    writeBytes(ASCII_ESC, 'R', val);
 }
 
 // Selects alt symbols for 'upper' ASCII values 0x80-0xFF
 void Adafruit_Thermal::setCodePage(uint8_t val) {
   if (val > 47)
     val = 47;
-  writeBytes(ASCII_ESC, 't', val);
+  if (stateChanged(SHADOW_CODEPAGE, val))
+    writeBytes(ASCII_ESC, 't', val);
 }
 
-void Adafruit_Thermal::tab() {
-  writeBytes(ASCII_TAB);
-  column = (column + 4) & 0b11111100;
-}
+void Adafruit_Thermal::tab() { write(ASCII_TAB); }
 
 void Adafruit_Thermal::setFont(uint8_t font) {
   // See ESC/POS Documentation  https://download4.epson.biz/sec_pubs/pos/reference_en/escpos/esc_cm.html
@@ -824,11 +3719,182 @@ void Adafruit_Thermal::setFont(uint8_t font) {
     font = (font > 4 ? 0: font);                            // Allow entering numeric value instead of letters (A=0, B=1, etc...)
   }
   fontData = (fontData & 248) | font;                       //Update Font, but keep styling
-  adjustCharValues();
+  styleChanged();
 }
 
 void Adafruit_Thermal::setCharSpacing(int spacing) {
-  writeBytes(ASCII_ESC, ' ', spacing);
+  if (stateChanged(SHADOW_SPACING, spacing))
+    writeBytes(ASCII_ESC, ' ', spacing);
+  charSpacing = spacing;
 }
 
 // -------------------------------------------------------------------------
+
+// === UTF-8 text ===
+
+// printUTF8() maps each code point to a byte in one of the code pages in
+// Adafruit_ThermalCodePages.h (generated by python/codepage_tables.py),
+// in a few table lookups.  A character the selected page holds costs
+// nothing extra.  One it lacks forces an ESC t, and the page picked then
+// is the one that holds the longest run of the text that follows, which
+// keeps the switches to the fewest possible.  The run is scanned once,
+// and the next scan starts where it ended, so the work per character
+// stays constant.
+
+static uint8_t textByte(const char *s, bool fromProgMem) {
+  return fromProgMem ? pgm_read_byte(s) : *s;
+}
+
+// Decodes the UTF-8 sequence at s and sets *len to its length in bytes.
+// A malformed sequence decodes as U+FFFD, one byte at a time.
+static uint32_t decodeUTF8(const char *s, bool fromProgMem, uint8_t *len) {
+  uint8_t b = textByte(s, fromProgMem), n;
+  uint32_t u;
+
+  *len = 1;
+  if (b < 0x80)
+    return b;
+  if ((b >= 0xC2) && (b <= 0xDF)) {
+    n = 1;
+    u = b & 0x1F;
+  } else if ((b >= 0xE0) && (b <= 0xEF)) {
+    n = 2;
+    u = b & 0x0F;
+  } else if ((b >= 0xF0) && (b <= 0xF4)) {
+    n = 3;
+    u = b & 0x07;
+  } else {
+    return 0xFFFD;
+  }
+  for (uint8_t i = 1; i <= n; i++) { // Stops at the NUL of a cut sequence
+    b = textByte(s + i, fromProgMem);
+    if ((b & 0xC0) != 0x80)
+      return 0xFFFD;
+    u = (u << 6) | (b & 0x3F);
+  }
+  if (((n == 2) && ((u < 0x800) || ((u >= 0xD800) && (u <= 0xDFFF)))) ||
+      ((n == 3) && ((u < 0x10000) || (u > 0x10FFFF))))
+    return 0xFFFD; // Overlong, surrogate or out of range
+  *len = n + 1;
+  return u;
+}
+
+// Table block holding code point u, or 0 if no page has it.
+static uint8_t utf8Block(uint32_t u) {
+  uint8_t row;
+  if ((u >= UTF8_LIMIT) || !(row = pgm_read_byte(&utf8Rows[u >> 8])))
+    return 0;
+  return pgm_read_byte(&utf8RowBlocks[row - 1][(u >> 4) & 15]);
+}
+
+// Byte for code point u in page p, or 0 if the page lacks it.
+static uint8_t utf8Byte(uint8_t block, uint32_t u, uint8_t p) {
+  uint8_t slice = pgm_read_byte(&utf8Blocks[block - 1][p]);
+  return pgm_read_byte(&utf8Slices[slice][u & 15]);
+}
+
+// Bit p set for each page p holding code point u; all of them for ASCII.
+static uint8_t utf8Pages(uint32_t u) {
+  uint8_t block, pages = 0;
+  if (u < 0x80)
+    return 0xFF;
+  if ((block = utf8Block(u))) {
+    for (uint8_t p = 0; p < UTF8_PAGES; p++) {
+      if (utf8Byte(block, u, p))
+        pages |= 1 << p;
+    }
+  }
+  return pages;
+}
+
+// Page to switch to for a character held by pages, followed by text s:
+// the one that also holds the most characters after it.  Characters in
+// no page don't care which is selected.
+static uint8_t utf8BestPage(const char *s, bool fromProgMem, uint8_t pages) {
+  uint8_t len, p = 0;
+  for (; textByte(s, fromProgMem); s += len) {
+    uint8_t next = utf8Pages(decodeUTF8(s, fromProgMem, &len));
+    if (next) {
+      if (!(pages & next))
+        break;
+      pages &= next;
+    }
+  }
+  while (!(pages & 1)) {
+    pages >>= 1;
+    p++;
+  }
+  return p;
+}
+
+// User-defined character standing in for code point u, or 0 if none.
+uint8_t Adafruit_Thermal::utf8Fallback(uint32_t u) {
+  for (uint8_t i = 0; i < THERMAL_UTF8_FALLBACKS; i++) {
+    if (utf8Chars[i] && (utf8Codes[i] == u))
+      return utf8Chars[i];
+  }
+  return 0;
+}
+
+bool Adafruit_Thermal::setUTF8Fallback(uint32_t codePoint, uint8_t charCode) {
+  uint8_t i, slot = THERMAL_UTF8_FALLBACKS;
+
+  if ((codePoint < 0x80) || (codePoint > 0xFFFF) ||
+      (charCode && ((charCode < 32) || (charCode > 126))))
+    return false;
+  for (i = 0; i < THERMAL_UTF8_FALLBACKS; i++) {
+    if (utf8Chars[i] && (utf8Codes[i] == codePoint)) {
+      slot = i; // Replace the existing entry
+      break;
+    }
+    if (!utf8Chars[i] && (slot == THERMAL_UTF8_FALLBACKS))
+      slot = i;
+  }
+  if (slot == THERMAL_UTF8_FALLBACKS)
+    return !charCode; // Full, unless there was nothing to add
+  utf8Codes[slot] = codePoint;
+  utf8Chars[slot] = charCode;
+  return true;
+}
+
+// The user-defined set is switched on for fallback glyphs only, and back
+// off before an ASCII character that has a user-defined glyph of its own
+// (the others print the same either way), so plain text keeps the look
+// the caller chose.
+void Adafruit_Thermal::printUTF8(const char *text, bool fromProgMem) {
+  uint8_t page = UTF8_PAGES, len, c; // UTF8_PAGES: page not known
+  bool user = userChars;
+
+  if (shadowValid & (1UL << SHADOW_CODEPAGE)) {
+    for (uint8_t p = 0; p < UTF8_PAGES; p++) {
+      if (pgm_read_byte(&utf8PageCodes[p]) == shadow[SHADOW_CODEPAGE])
+        page = p;
+    }
+  }
+  for (; textByte(text, fromProgMem); text += len) {
+    uint32_t u = decodeUTF8(text, fromProgMem, &len);
+    uint8_t pages = utf8Pages(u);
+    if ((u >= 0x80) && pages) {
+      if ((page == UTF8_PAGES) || !(pages & (1 << page))) {
+        page = utf8BestPage(text + len, fromProgMem, pages);
+        setCodePage(pgm_read_byte(&utf8PageCodes[page]));
+      }
+      c = utf8Byte(utf8Block(u), u, page);
+    } else if ((u >= 0x80) && (c = utf8Fallback(u))) {
+      if (!userChars)
+        userCharacterSetOn();
+    } else {
+      c = (u < 0x80) ? u : '?';
+      if ((userChars != user) && (c >= ' ') &&
+          ((userWidths[(c - 32) >> 1] >> ((c & 1) << 2)) & 0x0F))
+        userCharacterSetOff(); // c has a glyph of its own
+    }
+    write(c);
+  }
+  if (userChars != user)
+    userCharacterSetOff();
+}
+
+void Adafruit_Thermal::printUTF8(const __FlashStringHelper *text) {
+  printUTF8(reinterpret_cast<const char *>(text), true);
+}
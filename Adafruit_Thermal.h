@@ -7,6 +7,78 @@
 
 #include "Arduino.h"
 
+// saveTimes() and loadTimes() are available when the sketch includes
+// EEPROM.h ahead of this header.
+#if defined(__has_include)
+#if __has_include(<EEPROM.h>)
+#include <EEPROM.h>
+#define THERMAL_HAS_EEPROM //!< EEPROM library found; enables saveTimes()
+#endif
+#endif
+
+/*!
+ * Firmware version to pass to begin() for printers with a full ESC/POS
+ * command set, such as the DFRobot GY-EH402.  Bitmaps are then sent with
+ * GS v 0 instead of DC2 *.
+ */
+#define FIRMWARE_ESCPOS 300
+
+// Uncomment (or add -DTHERMAL_STATS to the build flags) to collect
+// ThermalStats counters, read with getStats().  The counters take room
+// in every Adafruit_Thermal either way, so a sketch that sets this where
+// the library does not still agrees with it on the class layout.
+// #define THERMAL_STATS
+
+// THERMAL_CMD_BUFFER_SIZE, THERMAL_WORD_MAX, THERMAL_GLYPH_CACHE,
+// THERMAL_UTF8_FALLBACKS and THERMAL_QR_VERSION_MAX size the library's
+// buffers, most of them inside Adafruit_Thermal, so the library and the
+// sketch must agree on them.  Change them here or with global build
+// flags (-D...), never with a #define in a sketch: the library is
+// compiled on its own and wouldn't see it.
+
+#ifndef THERMAL_CMD_BUFFER_SIZE
+#define THERMAL_CMD_BUFFER_SIZE 32 //!< Bytes of command staging buffer
+#endif
+
+#ifndef THERMAL_WORD_MAX
+#define THERMAL_WORD_MAX 32 //!< Longest word held back by wordWrapOn()
+#endif
+
+// Set to 1 to have userDefinedCharacter() remember which glyphs the
+// printer already holds (192 bytes of RAM) and upload only the rest
+#ifndef THERMAL_GLYPH_CACHE
+#if defined(__AVR__)
+#define THERMAL_GLYPH_CACHE 0 //!< Off: every glyph is uploaded each time
+#else
+#define THERMAL_GLYPH_CACHE 1 //!< On: resident glyphs aren't sent again
+#endif
+#endif
+
+// Code points setUTF8Fallback() can map to user-defined characters
+#ifndef THERMAL_UTF8_FALLBACKS
+#define THERMAL_UTF8_FALLBACKS 8 //!< 3 bytes of RAM each
+#endif
+
+// Largest QR code version printQRCode() can draw itself on printers
+// without native 2D symbols; the encoder's two work buffers grow with
+// the square of the size (about 500 bytes at 6, 1.5 KB at 15)
+#ifndef THERMAL_QR_VERSION_MAX
+#if defined(__AVR__)
+#define THERMAL_QR_VERSION_MAX 6 //!< Up to 41x41 modules
+#else
+#define THERMAL_QR_VERSION_MAX 15 //!< Up to 77x77 modules
+#endif
+#endif
+
+#ifdef ARDUINO_ARCH_ESP32
+#ifndef THERMAL_TASK_STACK
+#define THERMAL_TASK_STACK 3072 //!< Stack size of the beginTask() task
+#endif
+#ifndef THERMAL_TASK_PRIORITY
+#define THERMAL_TASK_PRIORITY 2 //!< Priority of the beginTask() task
+#endif
+#endif
+
 // Internal character sets used with ESC R n
 #define CHARSET_USA 0           //!< American character set
 #define CHARSET_FRANCE 1        //!< French character set
@@ -72,6 +144,26 @@
 #define CODEPAGE_CP856 46       //!< Hebrew character code page
 #define CODEPAGE_CP874 47       //!< Thai character code page
 
+// Transforms for printBitmapTransformed(); rotation is applied first
+#define BITMAP_INVERT 0x01     //!< Swap black and white
+#define BITMAP_MIRROR 0x02     //!< Flip left to right
+#define BITMAP_FLIP 0x04       //!< Flip top to bottom
+#define BITMAP_ROTATE 0x08     //!< Rotate 90 degrees clockwise
+#define BITMAP_ROTATE_180 0x06 //!< Rotate 180 degrees (MIRROR | FLIP)
+#define BITMAP_ROTATE_270 0x0E //!< Rotate 90 degrees counterclockwise
+
+// QR code error correction levels for printQRCode()
+#define QR_ECC_L 0 //!< Recovers about 7% of the symbol
+#define QR_ECC_M 1 //!< Recovers about 15% of the symbol
+#define QR_ECC_Q 2 //!< Recovers about 25% of the symbol
+#define QR_ECC_H 3 //!< Recovers about 30% of the symbol
+
+// Dithering and scaling options for printGrayscale(); OR in SCALE_NEAREST
+#define DITHER_DIFFUSE 0     //!< Floyd-Steinberg error diffusion
+#define DITHER_ORDERED 1     //!< 4x4 Bayer ordered dither
+#define DITHER_THRESHOLD 2   //!< Plain 50% threshold, for line art
+#define SCALE_NEAREST 0x10   //!< Downscale by sampling instead of averaging
+
 /*!
  * Barcode types used with GS k m
  */
@@ -87,10 +179,58 @@ enum barcodes {
   CODE128, /**< CODE128 barcode system. 2<=num<=255 */
 };
 
+// Barcode text positions for setBarcodeLabel()
+#define BARCODE_LABEL_NONE 0  //!< No text
+#define BARCODE_LABEL_ABOVE 1 //!< Text above the bars
+#define BARCODE_LABEL_BELOW 2 //!< Text below the bars
+#define BARCODE_LABEL_BOTH 3  //!< Text above and below
+
+// Kinds of traffic counted in ThermalStats::kindBytes[]
+#define STATS_COMMAND 0 //!< Setup and formatting commands
+#define STATS_TEXT 1    //!< Printable text
+#define STATS_BITMAP 2  //!< Bitmap commands and rows
+#define STATS_BARCODE 3 //!< Barcode commands and data
+
+/*!
+ * Printer traffic and wait counters, collected when THERMAL_STATS is
+ * defined.  Waits are only counted in blocking mode; in asynchronous
+ * mode poll() never waits.
+ */
+struct ThermalStats {
+  uint32_t bytes;        //!< Total bytes sent (or queued) to the printer
+  uint32_t kindBytes[4]; //!< Bytes by STATS_* kind
+  uint32_t waitMicros;   //!< Total time blocked waiting on the printer
+  uint32_t maxWait;      //!< Longest single wait, in microseconds
+  uint16_t waits;        //!< Number of waits that blocked
+  uint16_t waitHistogram[4]; //!< Waits under 1 ms, 10 ms, 100 ms, longer
+  uint16_t dtrStalls;        //!< Waits in which DTR held off data
+};
+
+// Printer conditions passed to the ThermalStatusCallback
+#define STATUS_PAPER_OUT 0x01  //!< Paper roll sensor reports paper end
+#define STATUS_COVER_OPEN 0x02 //!< Printer cover is open
+#define STATUS_OFFLINE 0x04    //!< Printer reports itself offline
+
+/*!
+ * @brief Called when a status reply changes the printer's conditions
+ * @param flags STATUS_* flags now in effect
+ */
+typedef void (*ThermalStatusCallback)(uint8_t flags);
+
+/*!
+ * @brief Called by poll() each time an asynchronous job has been printed
+ * @param job Number of the finished job, as returned by endJob()
+ * @param queued Bytes still waiting in the job queue
+ */
+typedef void (*ThermalJobCallback)(uint16_t job, uint16_t queued);
+
+class Adafruit_ThermalPool;
+
 /*!
  * Driver for the thermal printer
  */
 class Adafruit_Thermal : public Print {
+  friend class Adafruit_ThermalPool;
 
 public:
   // IMPORTANT: constructor syntax has changed from prior versions
@@ -119,7 +259,44 @@ public:
      */
     autoLineHeightOff(),
     /*!
-     * @param version firmware version as integer, e.g. 268 = 2.68 firmware
+     * @brief Enables Automatic Status Back: the printer reports paper,
+     *        cover and error changes by itself, poll() keeps the status
+     *        cache up to date from them, and getStatus() and hasPaper()
+     *        answer from the cache.  Asynchronous printing pauses while
+     *        the printer is out of paper or its cover is open.  Needs a
+     *        full ESC/POS printer with its TX line wired.
+     */
+    autoStatusOn(),
+    /*!
+     * @brief Disables Automatic Status Back
+     */
+    autoStatusOff(),
+    /*!
+     * @brief Switches to asynchronous mode. Printing calls then append to a
+     *        job queue in the supplied buffer instead of waiting on the
+     *        printer, and poll() must be called regularly to send it.
+     *        Call begin() and wake() before this.
+     * @param buf Storage for the job queue (at least 8 bytes)
+     * @param size Size of buf in bytes
+     */
+    beginAsync(uint8_t *buf, uint16_t size),
+    /*!
+     * @brief Starts recording printing calls into a composed job instead
+     *        of sending them.  The recording keeps the bytes and their
+     *        pacing, and can be replayed any number of times with
+     *        printComposed().  Ends asynchronous mode.
+     * @param buf Storage for the composed job (at least 8 bytes)
+     * @param size Size of buf in bytes
+     */
+    beginCompose(uint8_t *buf, uint16_t size),
+    /*!
+     * @brief Starts holding back printer commands so that consecutive
+     *        commands are sent together in one block write. Batches nest.
+     */
+    beginBatch(),
+    /*!
+     * @param version firmware version as integer, e.g. 268 = 2.68 firmware,
+     *        or FIRMWARE_ESCPOS for printers with the full ESC/POS set
      */
     begin(uint16_t version=268),
     /*!
@@ -135,9 +312,33 @@ public:
      */
     cancelKanjiMode(),
     /*!
-     * @brief Clears a user-defined character
+     * @brief Clears a user-defined character (and forgets that it was
+     *        loaded)
      */
     clearUserCharacter(uint8_t charVal=32),
+    /*!
+     * @brief Sends any deferred style changes and goes back to sending
+     *        style changes as they are made
+     */
+    deferStyleOff(),
+    /*!
+     * @brief Holds style changes (bold, size, font, etc.) until the next
+     *        text, barcode or bitmap, then sends them as one update
+     */
+    deferStyleOn(),
+    /*!
+     * @brief Goes back to charging every printed dot row the full
+     *        print time
+     */
+    densityTimingOff(),
+    /*!
+     * @brief Times each printed dot row by how many dots it fires.  A row
+     *        that needs every heating pass (see setHeatConfig()) takes the
+     *        print time, a blank row the feed time, with rows in between
+     *        scaled by their number of passes.  Bitmap rows are counted
+     *        exactly; text is estimated from its glyphs and style.
+     */
+    densityTimingOn(),
     /*!
      * @brief Disables double-height text
      */
@@ -154,6 +355,43 @@ public:
      * @brief Enables double-width text
      */
     doubleWidthOn(),
+    /*!
+     * @brief Records a placeholder in the job being composed, filled in
+     *        by printComposed() with fields[id].  The text recorded after
+     *        it is laid out as if the field took no room on the line, so
+     *        end the line after a field that might not fit.
+     * @param id Index of the field
+     */
+    composeField(uint8_t id),
+    /*!
+     * @brief Blocks until the asynchronous job queue has been sent
+     */
+    drain(),
+    /*!
+     * @brief Sends whatever is left in the job queue and returns to
+     *        normal blocking mode
+     */
+    endAsync(),
+    /*!
+     * @brief Prints a job recorded with beginCompose(), with its original
+     *        pacing.  In asynchronous mode it is queued like any other
+     *        printing.  Fields wrap from where the line stood in the
+     *        recording, measured in the current style, and the line is
+     *        left where the recording ended.
+     * @param job The recording (see endCompose() for its length)
+     * @param len Length of the recording in bytes
+     * @param fields Strings printed in place of composeField() slots
+     * @param numFields Number of entries in fields
+     * @param fromProgMem True if job is in PROGMEM
+     */
+    printComposed(const uint8_t *job, uint16_t len,
+                  const char *const *fields=NULL, uint8_t numFields=0,
+                  bool fromProgMem=false),
+    /*!
+     * @brief Ends a batch opened with beginBatch(). The outermost call
+     *        sends all held-back commands with a single pacing wait.
+     */
+    endBatch(),
     /*!
      * @brief Feeds by the specified number of lines 
      * @param x How many lines to feed 
@@ -168,6 +406,13 @@ public:
      * @brief Flush data pending in the printer 
      */
     flush(),
+    /*!
+     * @brief Forgets the printer state cached to skip repeated style
+     *        commands and glyph uploads, so the next ones are all sent.
+     *        Call after sending raw commands with write() or
+     *        power-cycling the printer.
+     */
+    invalidateState(),
     /*!
      * @brief Disables white/black reverse printing mode
      */
@@ -189,12 +434,6 @@ public:
      * @brief Put the printer into an online state after previously put offline
      */
     online(),
-    /*!
-     * @brief Print a barcode
-     * @param text The specified text/number (the meaning varies based on the type of barcode) and type to write to the barcode
-     * @param type Value from the datasheet or class-level variables like UPC-A. Note the type value changes depending on the firmware version so use class-level values where possible
-     */
-    printBarcode(const char *text, uint8_t type),
     /*!
      * @brief Prints a bitmap
      * @param w Width of the image in pixels
@@ -204,17 +443,32 @@ public:
      */
     printBitmap(int w, int h, const uint8_t *bitmap, bool fromProgMem=true),
     /*!
-     * @brief Prints a bitmap
-     * @param w Width of the image in pixels
-     * @param h Height of the image in pixels
-     * @param fromStream Stream to get bitmap data from
+     * @brief Prints a bitmap rotated, mirrored and/or inverted on the fly
+     * @param w Width of the stored image in pixels
+     * @param h Height of the stored image in pixels
+     * @param bitmap Bitmap data, in the same format as printBitmap()
+     * @param transform BITMAP_* flags
+     * @param fromProgMem True if bitmap is in PROGMEM
      */
-    printBitmap(int w, int h, Stream *fromStream),
+    printBitmapTransformed(int w, int h, const uint8_t *bitmap,
+                           uint8_t transform, bool fromProgMem=true),
     /*!
-     * @brief Prints a bitmap
-     * @param fromStream Stream to get bitmap data from
+     * @brief Prints UTF-8 text.  Each character is looked up in a set of
+     *        code pages (CP437, WCP1252, CP858, CP852, CP866, WCP1251,
+     *        WCP1253 and WCP1257), and ESC t is sent only when the
+     *        current page lacks it, choosing the page that lasts
+     *        longest, so mixed-script text takes the fewest switches.
+     *        Characters in none of them print as their setUTF8Fallback()
+     *        glyph, or '?'.  The last page used stays selected.
+     * @param text NUL-terminated UTF-8 text
+     * @param fromProgMem True if text is in PROGMEM
+     */
+    printUTF8(const char *text, bool fromProgMem=false),
+    /*!
+     * @brief Prints UTF-8 text stored with F()
+     * @param text Text in PROGMEM
      */
-    printBitmap(Stream *fromStream),
+    printUTF8(const __FlashStringHelper *text),
     /*!
      * @brief Sets text to normal mode
      */
@@ -228,11 +482,43 @@ public:
      * @param val Desired height of the barcode
      */
     setBarcodeHeight(uint8_t val=50),
+    /*!
+     * @brief Sets the width of a barcode's narrowest bar
+     * @param val Width in dots (2-6, default 3)
+     */
+    setBarcodeWidth(uint8_t val=3),
+    /*!
+     * @brief Sets where a barcode's text is printed
+     * @param position BARCODE_LABEL_NONE, BARCODE_LABEL_ABOVE,
+     *        BARCODE_LABEL_BELOW (default) or BARCODE_LABEL_BOTH
+     */
+    setBarcodeLabel(uint8_t position=BARCODE_LABEL_BELOW),
+    /*!
+     * @brief Sets the size of the printer's input buffer, used to keep it
+     *        full without overrunning it
+     * @param size Buffer size in bytes (default 256)
+     */
+    setBufferSize(uint16_t size=256),
     /*!
      * @brief Sets the font
      * @param font Desired font, either A or B
      */
     setFont(uint8_t font='A'),
+    /*!
+     * @brief Sets the function called as each asynchronous job completes
+     * @param callback Function to call, or NULL for none
+     */
+    setJobCallback(ThermalJobCallback callback),
+    /*!
+     * @brief Sets the function called when a status reply changes the
+     *        paper, cover or offline conditions.  With an interval,
+     *        poll() also requests cover and paper status in turn, so
+     *        they are watched during a job.
+     * @param callback Function to call, or NULL for none
+     * @param interval Milliseconds between monitoring requests, or 0
+     *        to only report replies to requestStatus() and getStatus()
+     */
+    setStatusCallback(ThermalStatusCallback callback, uint16_t interval=0),
     /*!
      * @brief Sets the character spacing
      * @param spacing Desired character spacing
@@ -265,8 +551,8 @@ public:
      */
     setLineHeight(int val=30),
     /*!
-     * @brief Set max rows to write
-     * @param val Max rows to write
+     * @brief Set max rows to write per bitmap command
+     * @param val Max rows to write (up to 255 for older firmware)
      */
     setMaxChunkHeight(int val=256),
     /*!
@@ -350,51 +636,453 @@ public:
      */
     userCharacterSetOff(),
     /*!
-     * @brief Set user-defined characters (one or many), must supply array size
+     * @brief Set user-defined characters (one or many), must supply array size.
+     *        The glyphs go out as one ESC & frame.  With
+     *        THERMAL_GLYPH_CACHE, glyphs the printer already holds are
+     *        left out, so a set can be loaded before every receipt.
      */
     userDefinedCharacter(uint8_t y_bytes=3, uint8_t charCodeFrom=32, uint8_t charCodeTo=32, int arySize=0, const uint8_t *charBytes={}),
     /*!
      * @brief Wakes device that was in sleep mode
      */
-    wake();
+    wake(),
+    /*!
+     * @brief Sends any held-back word and stops wrapping at word breaks
+     */
+    wordWrapOff(),
+    /*!
+     * @brief Wraps text at spaces rather than mid-word.  Each word is held
+     *        back (up to THERMAL_WORD_MAX characters) until its width is
+     *        known, and moved to a new line if it won't fit.
+     */
+    wordWrapOn();
     /*!
      * @brief Whether or not the printer has paper
      * @return Returns true if there is still paper
      */
     bool hasPaper();
+    /*!
+     * @brief Prints a bitmap read from a stream.  The next row is read
+     *        ahead while the printer catches up.  A read that outlasts
+     *        the stream's setTimeout() ends the image: the rows left in
+     *        its current chunk are printed blank.
+     * @param w Width of the image in pixels
+     * @param h Height of the image in pixels
+     * @param fromStream Stream to get bitmap data from
+     * @return Returns false if the stream ran out before the last row
+     */
+    bool printBitmap(int w, int h, Stream *fromStream);
+    /*!
+     * @brief Prints a bitmap read from a stream, preceded by its width
+     *        and height as 16-bit little-endian values
+     * @param fromStream Stream to get bitmap data from
+     * @return Returns false if the stream ran out before the last row
+     */
+    bool printBitmap(Stream *fromStream);
+    /*!
+     * @brief Prints a 1-bit uncompressed Windows BMP file, such as one
+     *        opened from an SD card.  Rows are read one at a time, seeking
+     *        to each in turn, so bottom-up files (the usual kind) need no
+     *        image buffer.  Whichever palette color is darker prints black.
+     * @param file Open file positioned anywhere: any Stream with a
+     *        seek(uint32_t) method, such as the SD and FS libraries' File
+     * @return Returns false if the file isn't a 1-bit BMP or is cut short
+     */
+    template <class F> bool printBMP(F &file) {
+      return printBMPFile(&file, seekFile<F>);
+    }
+    /*!
+     * @brief Prints a binary PBM (P4) image read from a stream.  PBM rows
+     *        are already in printer order, so a file, or a serial port,
+     *        is read straight through with no conversion.
+     * @param fromStream Stream positioned at the "P4" magic number
+     * @return Returns false if the header isn't a P4 header or the data is
+     *         cut short
+     */
+    bool printPBM(Stream *fromStream);
+    /*!
+     * @brief Dithers and prints an 8-bit grayscale image read from a
+     *        stream (one byte per pixel, 0 = black, 255 = white).  Images
+     *        wider than 384 pixels are shrunk by the smallest integer
+     *        factor that fits.  A read that outlasts the stream's
+     *        setTimeout() ends the image: the rows left in its current
+     *        chunk are printed blank.
+     * @param w Width of the image in pixels
+     * @param h Height of the image in pixels
+     * @param fromStream Stream to read the pixels from
+     * @param mode DITHER_DIFFUSE, DITHER_ORDERED or DITHER_THRESHOLD,
+     *        optionally ORed with SCALE_NEAREST
+     * @return Returns false if the image is too wide or the stream ran
+     *         dry before its end
+     */
+    bool printGrayscale(int w, int h, Stream *fromStream,
+                        uint8_t mode=DITHER_DIFFUSE);
+    /*!
+     * @brief Prints a bitmap stored in the compressed (row-delta PackBits)
+     *        format written by the converter scripts' --compress option.
+     *        Data that runs out before the last row ends the image: the
+     *        rows left in its current chunk are printed blank.
+     * @param w Width of the image in pixels
+     * @param h Height of the image in pixels
+     * @param data Compressed bitmap data
+     * @param len Length of data in bytes (e.g. sizeof the array)
+     * @param fromProgMem True if data is in PROGMEM
+     * @return Returns false if the data ran out before the image's end
+     */
+    bool printBitmapCompressed(int w, int h, const uint8_t *data,
+                               size_t len, bool fromProgMem=true);
+    /*!
+     * @brief Print a barcode.  The text is checked against the
+     *        symbology's length and character rules first, and the whole
+     *        command goes out in one block.
+     * @param text The specified text/number (the meaning varies based on the type of barcode) and type to write to the barcode
+     * @param type Value from the datasheet or class-level variables like UPC-A. Note the type value changes depending on the firmware version so use class-level values where possible
+     * @return Returns false, printing nothing, if the text can't be
+     *         encoded by that barcode type
+     */
+    bool printBarcode(const char *text, uint8_t type);
+    /*!
+     * @brief Prints a QR code (model 2, byte mode).  Printers with the
+     *        full ESC/POS set (see FIRMWARE_ESCPOS) draw it themselves
+     *        from the text alone, via GS ( k; on others it is encoded
+     *        here, up to version THERMAL_QR_VERSION_MAX, and printed as
+     *        a bitmap a row at a time.
+     * @param text Text to encode
+     * @param moduleSize Width of a module in dots (1-16); shrunk if the
+     *        code would be wider than the paper
+     * @param ecc QR_ECC_L, QR_ECC_M, QR_ECC_Q or QR_ECC_H
+     * @return Returns false if the text is too long for any QR version
+     *         this printer can print
+     */
+    bool printQRCode(const char *text, uint8_t moduleSize=4,
+                     uint8_t ecc=QR_ECC_M);
+    /*!
+     * @brief Prints a PDF417 symbol with the printer's GS ( k command.
+     *        Only printers with the full ESC/POS set (FIRMWARE_ESCPOS)
+     *        have it; there is no bitmap fallback.
+     * @param text Text to encode
+     * @param moduleWidth Width of a module in dots (2-8)
+     * @param rowHeight Height of a row, in module widths (2-8)
+     * @param ecc Error correction level (0-8)
+     * @param columns Data columns (1-30), or 0 to let the printer choose
+     * @return Returns false if the printer can't print PDF417, or the
+     *         text is longer than a symbol holds (1850 characters, or
+     *         2710 digits)
+     */
+    bool printPDF417(const char *text, uint8_t moduleWidth=3,
+                     uint8_t rowHeight=3, uint8_t ecc=2, uint8_t columns=0);
+    /*!
+     * @brief Has printUTF8() print a code point that no code page holds
+     *        as a user-defined character (see userDefinedCharacter()).
+     *        The user-defined set is switched on just for those
+     *        characters.  U+FFFD stands for malformed UTF-8.
+     * @param codePoint Unicode code point, U+0080 to U+FFFF
+     * @param charCode Character code 32-126 holding its glyph, or 0 to
+     *        forget the code point
+     * @return Returns false if the arguments are out of range or all
+     *         THERMAL_UTF8_FALLBACKS entries are in use
+     */
+    bool setUTF8Fallback(uint32_t codePoint, uint8_t charCode);
     /*!
      * @brief Send printer status to host / Arduino
-     * @return Returns byte of data for the status page queried 
+     * @return Returns byte of data for the status page queried, or 255
+     *         if the printer doesn't answer within a second
      */
     int getStatus(uint8_t statusPage=1);
+    /*!
+     * @brief Asks for a status page without waiting for the reply, which
+     *        poll() collects into the status cache
+     * @param statusPage Status page to request (1-4, as for getStatus())
+     * @return Returns false if a request is already pending
+     */
+    bool requestStatus(uint8_t statusPage=1);
+    /*!
+     * @brief Whether a requestStatus() reply is still awaited
+     * @return Returns true until the reply arrives or times out
+     */
+    bool statusPending();
+    /*!
+     * @brief Last status byte received for a page
+     * @param statusPage Status page (1-4)
+     * @return Returns the status byte, or -1 if none has been received
+     */
+    int cachedStatus(uint8_t statusPage=1);
+    /*!
+     * @brief Time since the cached status for a page arrived
+     * @param statusPage Status page (1-4)
+     * @return Returns milliseconds, or 0xFFFFFFFF if none has arrived
+     */
+    unsigned long statusAge(uint8_t statusPage=1);
+    /*!
+     * @brief Printer conditions decoded from the cached status
+     * @return Returns STATUS_* flags
+     */
+    uint8_t statusFlags();
+    /*!
+     * @brief Sends as much of the asynchronous job queue as the printer's
+     *        time budget allows, without waiting
+     * @return Returns true while queued data remains
+     */
+    bool poll();
+    /*!
+     * @brief Marks the end of an asynchronous job
+     * @return Returns the job number later passed to the job callback
+     */
+    uint16_t endJob();
+    /*!
+     * @brief Stops recording a composed job and returns to blocking mode
+     * @return Returns the length of the recording, or 0 if it didn't fit
+     */
+    uint16_t endCompose();
+    /*!
+     * @brief Number of bytes waiting in the asynchronous job queue
+     * @return Returns queued bytes, including record overhead
+     */
+    uint16_t queuedBytes();
+#ifdef ARDUINO_ARCH_ESP32
+    /*!
+     * @brief Switches to asynchronous mode with poll() run by a FreeRTOS
+     *        task of its own, pinned to the given core, so printing calls
+     *        only queue and return.  The job and status callbacks are
+     *        then called on that task.  Calls that must hear from the
+     *        printer (getStatus(), hasPaper()) wait for the task to fetch
+     *        the answer; wake() only pauses.  endAsync() stops the task.
+     *        Call begin() and wake() before this.
+     * @param buf Storage for the job queue (at least 8 bytes)
+     * @param size Size of buf in bytes
+     * @param core Core to run the task on; Arduino's loop() runs on 1
+     * @return Returns false if the task couldn't be started, leaving the
+     *         printer in plain asynchronous mode (or blocking mode, if
+     *         buf is too small)
+     */
+    bool beginTask(uint8_t *buf, uint16_t size, uint8_t core=0);
+#endif
+    /*!
+     * @brief Estimated time until the printer has finished everything
+     *        sent and queued so far.  Only times the library paces by are
+     *        counted, so with DTR flow control this is mostly 0.
+     * @return Returns time in microseconds
+     */
+    unsigned long pendingTime();
+    /*!
+     * @brief Measures the real print and feed times using the DTR
+     *        handshake and loads them with setTimes(). Feeds a little
+     *        paper and prints a short bar. Requires a DTR pin.
+     * @return Returns true if both times were measured
+     */
+    bool calibrate();
+    /*!
+     * @brief Current estimate of the time to print one dot row
+     * @return Returns time in microseconds
+     */
+    unsigned long getDotPrintTime();
+    /*!
+     * @brief Current estimate of the time to feed one dot row
+     * @return Returns time in microseconds
+     */
+    unsigned long getDotFeedTime();
+#ifdef THERMAL_HAS_EEPROM
+    /*!
+     * @brief Stores the current print and feed times in EEPROM
+     * @param addr EEPROM address to store them at
+     */
+    void saveTimes(int addr=0);
+    /*!
+     * @brief Loads print and feed times stored by saveTimes(). Call after
+     *        begin(), which sets the default times.
+     * @param addr EEPROM address they were stored at
+     * @return Returns true if valid times were found
+     */
+    bool loadTimes(int addr=0);
+#endif
+    /*!
+     * @brief Takes a snapshot of the traffic and wait counters
+     * @param reset True to clear the counters afterward
+     * @return Returns the counters collected since the last reset; all
+     *         zero unless the library was built with THERMAL_STATS
+     */
+    ThermalStats getStats(bool reset=true);
 
 private:
+  /*!
+   * Supplies the first n (clipped) bytes of bitmap row y, either as a
+   * pointer into the source itself or by filling buf.  Sources that aren't
+   * seekable ignore y and return the next row.
+   */
+  typedef const uint8_t *(*BitmapRowSource)(void *ctx, int y, uint8_t *buf,
+                                            uint8_t n);
+  /*!
+   * Optional for row sources that read slowly: does some of the work for
+   * the next row without blocking, while the printer has no room.
+   * Returns false once there is nothing more it can do ahead of time.
+   */
+  typedef bool (*BitmapPrefetch)(void *ctx);
+  //! Moves a file to byte pos; returns false if it can't
+  typedef bool (*FileSeek)(Stream *file, uint32_t pos);
+  template <class F> static bool seekFile(Stream *file, uint32_t pos) {
+    return static_cast<F *>(file)->seek(pos);
+  }
+  bool printBMPFile(Stream *file, FileSeek seek);
+  void writeSymbol(uint8_t cn, uint8_t fn, uint8_t n),
+      storeSymbol(uint8_t cn, const char *text, uint16_t len);
+  // Printer settings mirrored in shadow[] (see stateChanged())
+  enum {
+    SHADOW_MODE,       // ESC ! print mode
+    SHADOW_FONT,       // ESC M font
+    SHADOW_SIZE,       // GS ! character size
+    SHADOW_LINE,       // ESC 3 line height
+    SHADOW_JUSTIFY,    // ESC a justification
+    SHADOW_UNDERLINE,  // ESC - underline weight
+    SHADOW_CHARSET,    // ESC R character set
+    SHADOW_CODEPAGE,   // ESC t code page
+    SHADOW_INVERSE,    // GS B reverse printing
+    SHADOW_UPDOWN,     // ESC { upside-down printing
+    SHADOW_SPACING,    // ESC SP character spacing
+    SHADOW_ONLINE,     // ESC = online/offline
+    SHADOW_BARCODE,    // GS h barcode height
+    SHADOW_BARWIDTH,   // GS w barcode module width
+    SHADOW_BARLABEL,   // GS H barcode text position
+    SHADOW_USERCHARS,  // ESC % user-defined character set
+    SHADOW_KANJI,      // FS . Kanji mode cancelled
+    SHADOW_COUNT
+  };
+
   Stream *stream;
   uint8_t printMode,
-      prevByte,      // Last character issued to printer
-      column,        // Last horizontal column printed
-      maxColumn,     // Page width (output 'wraps' at this point)
+      lineHeight,    // Tallest character on the current line, 0 if none
       charHeight,    // Height of characters, in 'dots'
       charWidth,     // Width of characters, in 'dots'
+      charSpacing,   // Right-side character spacing, in dots
       lineSpacing,   // Inter-line spacing (not line height), in dots
       barcodeHeight, // Barcode height in dots, not including text
-      maxChunkHeight,
+      barcodeWidth,  // Narrowest bar width in dots, for GS w
+      barcodeLabel,  // BARCODE_LABEL_* position, for GS H
+      justification, // 0 = left, 1 = center, 2 = right
       fontData,       // Selected Font & style
-      dtrPin;         // DTR handshaking pin (experimental)
-  uint16_t firmware;  // Firmware version
+      dtrPin,         // DTR handshaking pin (experimental)
+      learnRows,      // Dot rows in the busy period being timed, if any
+      cmdLen,         // Bytes waiting in cmdBuf
+      batchDepth,     // Nesting level of beginBatch()/endBatch()
+      cmdBuf[THERMAL_CMD_BUFFER_SIZE], // Command staging buffer
+      shadow[SHADOW_COUNT],            // Last value sent for each setting
+      userWidths[48], // Widths of user-defined characters 32-127, 4 bits each
+      wordLen,        // Characters held in wordBuf
+      wordBuf[THERMAL_WORD_MAX], // Word waiting to be placed by wordWrapOn()
+      utf8Chars[THERMAL_UTF8_FALLBACKS]; // setUTF8Fallback() glyphs, 0 = free
+  uint16_t utf8Codes[THERMAL_UTF8_FALLBACKS]; // ...and their code points
+  uint32_t shadowValid; // Bit per shadow[] entry known to match the printer
+#if THERMAL_GLYPH_CACHE
+  uint16_t glyphTags[96]; // Fingerprint of the glyph loaded at each of
+                          // codes 32-127; 0 if unknown
+#endif
+  uint16_t firmware,  // Firmware version
+      maxChunkHeight,  // Most rows to send per bitmap command
+      lineDots,        // Width of the current line so far, in dots
+      lineInk,         // Estimated dots fired per row of the current line
+      heatDots,        // Most dots fired at once (setHeatConfig())
+      learnPasses,     // Heating passes in the bitmap chunk being timed
+      wordDots;        // Width of the word in wordBuf, in dots
   boolean dtrEnabled, // True if DTR pin set & printer initialized
-      autoLineHeight; // if True, sets the lineheight based on selected font
+      autoLineHeight, // if True, sets the lineheight based on selected font
+      learnFeed,      // True if the busy period being timed is a feed
+      styleDeferred,  // True if style changes wait for flushStyle()
+      styleDirty,     // True if printMode/fontData haven't been sent
+      userChars,      // True if the user-defined character set is on
+      densityTiming,  // True if print time depends on dots fired
+      wordWrap;       // True if wrapping at word breaks
+  uint8_t *jobBuf; // Job queue storage, NULL when not in async mode
+  uint16_t jobSize, // Size of jobBuf
+      jobWr;        // Where the next queued byte goes
+  volatile uint16_t jobTail, // Next record for poll() to send
+      jobPub;                // End of the records a print task may read
+  volatile bool jobHungry, // Print task has sent everything published
+      jobCut;              // Published records may end inside a command
+#ifdef ARDUINO_ARCH_ESP32
+  TaskHandle_t jobTask; // Task running poll(), or NULL
+  volatile bool taskRun; // Cleared to stop the task
+#endif
+  uint16_t jobOpen, // Header of a data record that may still grow
+      jobDelay,     // Trailing delay record that may still be overwritten
+      jobCredit,    // Credit record that may still grow
+      jobSince,     // Data bytes queued since the last timing record
+      jobCount,     // Jobs queued so far
+      jobsDone;     // Jobs finished so far
+  ThermalJobCallback jobCallback;
+  ThermalStatusCallback statusCallback;
+  uint8_t statusWanted, // Page of the request awaiting a reply, or 0
+      statusNext,       // Page the status monitor asks for next
+      statusKnown,      // Bit n-1 set once page n has been received
+      statusBits,       // STATUS_* flags last reported
+      statusBytes[4];   // Last reply for each page
+  bool statusQueued, // Request is in the job queue, not yet sent
+      asbEnabled,    // True if Automatic Status Back is on
+      jobPaused;     // True while poll() waits out a paper or cover stop
+  uint8_t asbCount, // Bytes of the ASB block received so far
+      asbBuf[4];    // The ASB block being received
+  uint16_t statusInterval; // Status monitor period in ms, or 0 for none
+  unsigned long statusAsked, // millis() when the last request was sent
+      statusStamp[4],        // millis() when each page's reply arrived
+      pauseStart;            // micros() when poll() paused
+  uint16_t jobCredited; // Bytes covered by credits poll() has passed
+  bool composing,       // True if the job queue is a beginCompose() recording
+      composeOverflow;  // True if the recording ran out of room
+  uint16_t bufferSize,  // Printer input buffer size
+      bufferBytes;      // Est. bytes in printer buffer as of bufferStamp
   unsigned long
-      resumeTime,   // Wait until micros() exceeds this before sending byte
-      dotPrintTime, // Time to print a single dot line, in microseconds
-      dotFeedTime;  // Time to feed a single dot line, in microseconds
+      resumeTime,    // Wait until micros() exceeds this before sending byte
+      dotPrintTime,  // Time to print a single dot line, in microseconds
+      dotFeedTime,   // Time to feed a single dot line, in microseconds
+      learnStart,    // When the busy period being timed began
+      bufferStamp,   // When bufferBytes was last brought up to date
+      jobExtendTime, // Extend time not yet queued as a record
+      jobTime,       // Delay and extend time queued, incl. the above
+      jobTimeDone;   // Delay and extend time poll() has applied
+  Adafruit_ThermalPool *pool; // Pool this printer belongs to, if any
+  bool txBuffered; // True once the stream has reported TX buffer space
   void writeBytes(uint8_t a), writeBytes(uint8_t a, uint8_t b),
       writeBytes(uint8_t a, uint8_t b, uint8_t c),
       writeBytes(uint8_t a, uint8_t b, uint8_t c, uint8_t d),
       writeBytes(uint8_t a, uint8_t b, uint8_t c, uint8_t d, uint8_t e),
       writeCmdBytes(uint8_t a, uint8_t b, uint8_t c, bool d=false),
+      writeCommand(const uint8_t *cmd, uint8_t n), discardInput(),
+      pollStatus(), sendStatusRequest(), writeAsbMode(), asbByte(uint8_t b),
+      statusReply(uint8_t statusPage, uint8_t status),
       setPrintMode(uint8_t mask), unsetPrintMode(uint8_t mask),
-      writePrintMode(), adjustCharValues();
+      writePrintMode(), adjustCharValues(), styleChanged(), flushStyle(),
+      putChar(uint8_t c), flushWord(), setUserWidth(uint8_t c, uint8_t w),
+      sendBlock(const uint8_t *buf, size_t n),
+      queueByte(uint8_t b),
+      commitBytes(), sendBytes(const uint8_t *buf, size_t n),
+      queueData(const uint8_t *buf, size_t n), queueDelay(unsigned long x),
+      jobReserve(uint8_t n), jobPut(uint8_t b), jobFlushExtend(), learnTimes(),
+      queueCredit(uint16_t n), queueExtend(unsigned long x),
+      waitCredit(uint16_t n), timeoutExtend(unsigned long x),
+      bufferAdd(size_t n), bufferSettle(), paceBytes(size_t n),
+      feedBlankRows(int rows), composeLayout();
+  void jobPublish(bool whole), jobConsume(uint16_t to);
+  bool jobShared(), onPrintTask();
+#ifdef ARDUINO_ARCH_ESP32
+  static void printTask(void *arg);
+#endif
+  bool printerReady(), creditReady(uint16_t n),
+      stateChanged(uint8_t slot, uint8_t value),
+      statusProbe(unsigned long timeout),
+      printBitmapRows(int w, int h, BitmapRowSource getRow, void *ctx,
+                      bool seekable, BitmapPrefetch prefetch=NULL);
+  uint16_t bufferLevel();
+  uint8_t glyphWidth(uint8_t c), glyphInk(uint8_t c, uint8_t w),
+      heatPasses(uint16_t dots), utf8Fallback(uint32_t u);
+  unsigned long rowPrintTime(uint16_t dots);
+  unsigned long endLine();
+  uint16_t jobNext(uint16_t i);
+  // Sends a fixed ThermalCommand sequence (see Adafruit_Thermal.cpp)
+  template <class C> void writeCommand() {
+    writeCommand(C::bytes, sizeof C::bytes);
+  }
+  unsigned long busyTime(unsigned long start, unsigned long window);
+  ThermalStats stats; // Present without THERMAL_STATS too; see above
+  uint8_t statsKind;  // STATS_* kind of the bytes being sent
+  void statsWait(unsigned long start);
 };
 
 #endif // ADAFRUIT_THERMAL_H
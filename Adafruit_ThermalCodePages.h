@@ -0,0 +1,312 @@
+// Generated by python/codepage_tables.py; do not edit.
+// Unicode to code page tables for printUTF8(), in PROGMEM.
+
+#ifndef ADAFRUIT_THERMALCODEPAGES_H
+#define ADAFRUIT_THERMALCODEPAGES_H
+
+#define UTF8_PAGES 8 //!< Code pages in the tables
+#define UTF8_LIMIT 0x2600 //!< First code point past the tables
+
+// ESC t number of each page
+static const uint8_t PROGMEM utf8PageCodes[UTF8_PAGES] = {
+    CODEPAGE_CP437, CODEPAGE_WCP1252, CODEPAGE_CP858,
+    CODEPAGE_CP852, CODEPAGE_CP866, CODEPAGE_WCP1251,
+    CODEPAGE_WCP1253, CODEPAGE_WCP1257};
+
+// Code point >> 8 -> row number + 1, or 0 if none
+static const uint8_t PROGMEM utf8Rows[38] = {
+    1, 2, 3, 4, 5, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    6, 7, 8, 9, 0, 10};
+
+// Row, then code point >> 4 & 15 -> block number + 1, or 0
+static const uint8_t PROGMEM utf8RowBlocks[10][16] = {
+    {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 2, 3, 4, 5, 6},
+    {7, 8, 9, 10, 11, 12, 13, 14, 0, 15, 0, 0, 0, 0, 0, 0},
+    {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 16, 17, 0, 0},
+    {0, 0, 0, 0, 0, 0, 0, 0, 18, 19, 20, 21, 22, 0, 0, 0},
+    {23, 24, 25, 26, 27, 28, 0, 0, 0, 29, 0, 0, 0, 0, 0, 0},
+    {0, 30, 31, 32, 0, 0, 0, 33, 0, 0, 34, 0, 0, 0, 0, 0},
+    {0, 35, 36, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0},
+    {0, 37, 38, 0, 39, 0, 40, 0, 0, 0, 0, 0, 0, 0, 0, 0},
+    {0, 41, 42, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0},
+    {43, 44, 45, 46, 0, 47, 48, 0, 49, 50, 51, 0, 0, 0, 0, 0}};
+
+// Block, then page -> slice of 16 bytes (0 = not in page)
+static const uint8_t PROGMEM utf8Blocks[51][UTF8_PAGES] = {
+    {1, 2, 3, 4, 5, 6, 7, 8},
+    {9, 10, 11, 12, 13, 14, 15, 16},
+    {17, 18, 19, 20, 0, 0, 0, 21},
+    {22, 23, 24, 25, 0, 0, 0, 26},
+    {27, 28, 29, 30, 0, 0, 0, 31},
+    {32, 33, 34, 35, 0, 0, 0, 36},
+    {0, 0, 0, 37, 0, 0, 0, 38},
+    {0, 0, 0, 39, 0, 0, 0, 40},
+    {0, 0, 0, 0, 0, 0, 0, 41},
+    {0, 0, 0, 42, 0, 0, 0, 43},
+    {0, 0, 0, 44, 0, 0, 0, 45},
+    {0, 46, 0, 47, 0, 0, 0, 48},
+    {0, 49, 0, 50, 0, 0, 0, 51},
+    {0, 52, 0, 53, 0, 0, 0, 54},
+    {55, 56, 55, 0, 0, 0, 56, 0},
+    {0, 57, 0, 58, 0, 0, 0, 59},
+    {0, 60, 0, 61, 0, 0, 0, 62},
+    {0, 0, 0, 0, 0, 0, 63, 0},
+    {64, 0, 0, 0, 0, 0, 18, 0},
+    {65, 0, 0, 0, 0, 0, 66, 0},
+    {67, 0, 0, 0, 0, 0, 28, 0},
+    {68, 0, 0, 0, 0, 0, 69, 0},
+    {0, 0, 0, 0, 70, 71, 0, 0},
+    {0, 0, 0, 0, 72, 18, 0, 0},
+    {0, 0, 0, 0, 73, 23, 0, 0},
+    {0, 0, 0, 0, 2, 28, 0, 0},
+    {0, 0, 0, 0, 28, 33, 0, 0},
+    {0, 0, 0, 0, 74, 75, 0, 0},
+    {0, 0, 0, 0, 0, 76, 0, 0},
+    {0, 77, 78, 0, 0, 77, 79, 77},
+    {0, 80, 0, 0, 0, 80, 80, 80},
+    {0, 81, 0, 0, 0, 81, 81, 81},
+    {82, 0, 0, 0, 0, 0, 0, 0},
+    {83, 84, 85, 0, 0, 86, 84, 84},
+    {0, 0, 0, 0, 87, 88, 0, 0},
+    {0, 89, 0, 0, 0, 89, 89, 89},
+    {90, 0, 0, 0, 91, 0, 0, 0},
+    {92, 0, 0, 0, 0, 0, 0, 0},
+    {93, 0, 0, 0, 0, 0, 0, 0},
+    {94, 0, 0, 0, 0, 0, 0, 0},
+    {95, 0, 0, 0, 0, 0, 0, 0},
+    {96, 0, 0, 0, 0, 0, 0, 0},
+    {97, 0, 97, 97, 97, 0, 0, 0},
+    {98, 0, 98, 98, 98, 0, 0, 0},
+    {99, 0, 99, 99, 99, 0, 0, 0},
+    {100, 0, 100, 100, 100, 0, 0, 0},
+    {101, 0, 102, 102, 101, 0, 0, 0},
+    {103, 0, 104, 104, 103, 0, 0, 0},
+    {105, 0, 106, 106, 105, 0, 0, 0},
+    {107, 0, 108, 108, 107, 0, 0, 0},
+    {109, 0, 109, 109, 109, 0, 0, 0}};
+
+// Slice, then code point & 15 -> byte in the page, or 0
+static const uint8_t PROGMEM utf8Slices[110][16] = {
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+     0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00},
+    {0xFF, 0xAD, 0x9B, 0x9C, 0x00, 0x9D, 0x00, 0x00,
+     0x00, 0x00, 0xA6, 0xAE, 0xAA, 0x00, 0x00, 0x00},
+    {0xA0, 0xA1, 0xA2, 0xA3, 0xA4, 0xA5, 0xA6, 0xA7,
+     0xA8, 0xA9, 0xAA, 0xAB, 0xAC, 0xAD, 0xAE, 0xAF},
+    {0xFF, 0xAD, 0xBD, 0x9C, 0xCF, 0xBE, 0xDD, 0xF5,
+     0xF9, 0xB8, 0xA6, 0xAE, 0xAA, 0xF0, 0xA9, 0xEE},
+    {0xFF, 0x00, 0x00, 0x00, 0xCF, 0x00, 0x00, 0xF5,
+     0xF9, 0x00, 0x00, 0xAE, 0xAA, 0xF0, 0x00, 0x00},
+    {0xFF, 0x00, 0x00, 0x00, 0xFD, 0x00, 0x00, 0x00,
+     0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00},
+    {0xA0, 0x00, 0x00, 0x00, 0xA4, 0x00, 0xA6, 0xA7,
+     0x00, 0xA9, 0x00, 0xAB, 0xAC, 0xAD, 0xAE, 0x00},
+    {0xA0, 0x00, 0x00, 0xA3, 0xA4, 0xA5, 0xA6, 0xA7,
+     0xA8, 0xA9, 0x00, 0xAB, 0xAC, 0xAD, 0xAE, 0x00},
+    {0xA0, 0x00, 0xA2, 0xA3, 0xA4, 0x00, 0xA6, 0xA7,
+     0x8D, 0xA9, 0x00, 0xAB, 0xAC, 0xAD, 0xAE, 0x9D},
+    {0xF8, 0xF1, 0xFD, 0x00, 0x00, 0xE6, 0x00, 0xFA,
+     0x00, 0x00, 0xA7, 0xAF, 0xAC, 0xAB, 0x00, 0xA8},
+    {0xB0, 0xB1, 0xB2, 0xB3, 0xB4, 0xB5, 0xB6, 0xB7,
+     0xB8, 0xB9, 0xBA, 0xBB, 0xBC, 0xBD, 0xBE, 0xBF},
+    {0xF8, 0xF1, 0xFD, 0xFC, 0xEF, 0xE6, 0xF4, 0xFA,
+     0xF7, 0xFB, 0xA7, 0xAF, 0xAC, 0xAB, 0xF3, 0xA8},
+    {0xF8, 0x00, 0x00, 0x00, 0xEF, 0x00, 0x00, 0x00,
+     0xF7, 0x00, 0x00, 0xAF, 0x00, 0x00, 0x00, 0x00},
+    {0xF8, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xFA,
+     0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00},
+    {0xB0, 0xB1, 0x00, 0x00, 0x00, 0xB5, 0xB6, 0xB7,
+     0x00, 0x00, 0x00, 0xBB, 0x00, 0x00, 0x00, 0x00},
+    {0xB0, 0xB1, 0xB2, 0xB3, 0x00, 0xB5, 0xB6, 0xB7,
+     0x00, 0x00, 0x00, 0xBB, 0x00, 0xBD, 0x00, 0x00},
+    {0xB0, 0xB1, 0xB2, 0xB3, 0xB4, 0xB5, 0xB6, 0xB7,
+     0x8F, 0xB9, 0x00, 0xBB, 0xBC, 0xBD, 0xBE, 0x00},
+    {0x00, 0x00, 0x00, 0x00, 0x8E, 0x8F, 0x92, 0x80,
+     0x00, 0x90, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00},
+    {0xC0, 0xC1, 0xC2, 0xC3, 0xC4, 0xC5, 0xC6, 0xC7,
+     0xC8, 0xC9, 0xCA, 0xCB, 0xCC, 0xCD, 0xCE, 0xCF},
+    {0xB7, 0xB5, 0xB6, 0xC7, 0x8E, 0x8F, 0x92, 0x80,
+     0xD4, 0x90, 0xD2, 0xD3, 0xDE, 0xD6, 0xD7, 0xD8},
+    {0x00, 0xB5, 0xB6, 0x00, 0x8E, 0x00, 0x00, 0x80,
+     0x00, 0x90, 0x00, 0xD3, 0x00, 0xD6, 0xD7, 0x00},
+    {0x00, 0x00, 0x00, 0x00, 0xC4, 0xC5, 0xAF, 0x00,
+     0x00, 0xC9, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00},
+    {0x00, 0xA5, 0x00, 0x00, 0x00, 0x00, 0x99, 0x00,
+     0x00, 0x00, 0x00, 0x00, 0x9A, 0x00, 0x00, 0xE1},
+    {0xD0, 0xD1, 0xD2, 0xD3, 0xD4, 0xD5, 0xD6, 0xD7,
+     0xD8, 0xD9, 0xDA, 0xDB, 0xDC, 0xDD, 0xDE, 0xDF},
+    {0xD1, 0xA5, 0xE3, 0xE0, 0xE2, 0xE5, 0x99, 0x9E,
+     0x9D, 0xEB, 0xE9, 0xEA, 0x9A, 0xED, 0xE8, 0xE1},
+    {0x00, 0x00, 0x00, 0xE0, 0xE2, 0x00, 0x99, 0x9E,
+     0x00, 0x00, 0xE9, 0x00, 0x9A, 0xED, 0x00, 0xE1},
+    {0x00, 0x00, 0x00, 0xD3, 0x00, 0xD5, 0xD6, 0xD7,
+     0xA8, 0x00, 0x00, 0x00, 0xDC, 0x00, 0x00, 0xDF},
+    {0x85, 0xA0, 0x83, 0x00, 0x84, 0x86, 0x91, 0x87,
+     0x8A, 0x82, 0x88, 0x89, 0x8D, 0xA1, 0x8C, 0x8B},
+    {0xE0, 0xE1, 0xE2, 0xE3, 0xE4, 0xE5, 0xE6, 0xE7,
+     0xE8, 0xE9, 0xEA, 0xEB, 0xEC, 0xED, 0xEE, 0xEF},
+    {0x85, 0xA0, 0x83, 0xC6, 0x84, 0x86, 0x91, 0x87,
+     0x8A, 0x82, 0x88, 0x89, 0x8D, 0xA1, 0x8C, 0x8B},
+    {0x00, 0xA0, 0x83, 0x00, 0x84, 0x00, 0x00, 0x87,
+     0x00, 0x82, 0x00, 0x89, 0x00, 0xA1, 0x8C, 0x00},
+    {0x00, 0x00, 0x00, 0x00, 0xE4, 0xE5, 0xBF, 0x00,
+     0x00, 0xE9, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00},
+    {0x00, 0xA4, 0x95, 0xA2, 0x93, 0x00, 0x94, 0xF6,
+     0x00, 0x97, 0xA3, 0x96, 0x81, 0x00, 0x00, 0x98},
+    {0xF0, 0xF1, 0xF2, 0xF3, 0xF4, 0xF5, 0xF6, 0xF7,
+     0xF8, 0xF9, 0xFA, 0xFB, 0xFC, 0xFD, 0xFE, 0xFF},
+    {0xD0, 0xA4, 0x95, 0xA2, 0x93, 0xE4, 0x94, 0xF6,
+     0x9B, 0x97, 0xA3, 0x96, 0x81, 0xEC, 0xE7, 0x98},
+    {0x00, 0x00, 0x00, 0xA2, 0x93, 0x00, 0x94, 0xF6,
+     0x00, 0x00, 0xA3, 0x00, 0x81, 0xEC, 0x00, 0x00},
+    {0x00, 0x00, 0x00, 0xF3, 0x00, 0xF5, 0xF6, 0xF7,
+     0xB8, 0x00, 0x00, 0x00, 0xFC, 0x00, 0x00, 0x00},
+    {0x00, 0x00, 0xC6, 0xC7, 0xA4, 0xA5, 0x8F, 0x86,
+     0x00, 0x00, 0x00, 0x00, 0xAC, 0x9F, 0xD2, 0xD4},
+    {0xC2, 0xE2, 0x00, 0x00, 0xC0, 0xE0, 0xC3, 0xE3,
+     0x00, 0x00, 0x00, 0x00, 0xC8, 0xE8, 0x00, 0x00},
+    {0xD1, 0xD0, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+     0xA8, 0xA9, 0xB7, 0xD8, 0x00, 0x00, 0x00, 0x00},
+    {0x00, 0x00, 0xC7, 0xE7, 0x00, 0x00, 0xCB, 0xEB,
+     0xC6, 0xE6, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00},
+    {0x00, 0x00, 0xCC, 0xEC, 0x00, 0x00, 0x00, 0x00,
+     0x00, 0x00, 0xCE, 0xEE, 0x00, 0x00, 0xC1, 0xE1},
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+     0x00, 0x91, 0x92, 0x00, 0x00, 0x95, 0x96, 0x00},
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xCD, 0xED,
+     0x00, 0x00, 0x00, 0xCF, 0xEF, 0x00, 0x00, 0x00},
+    {0x00, 0x9D, 0x88, 0xE3, 0xE4, 0x00, 0x00, 0xD5,
+     0xE5, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00},
+    {0x00, 0xD9, 0xF9, 0xD1, 0xF1, 0xD2, 0xF2, 0x00,
+     0x00, 0x00, 0x00, 0x00, 0xD4, 0xF4, 0x00, 0x00},
+    {0x00, 0x00, 0x8C, 0x9C, 0x00, 0x00, 0x00, 0x00,
+     0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00},
+    {0x8A, 0x8B, 0x00, 0x00, 0xE8, 0xEA, 0x00, 0x00,
+     0xFC, 0xFD, 0x97, 0x98, 0x00, 0x00, 0xB8, 0xAD},
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xAA, 0xBA,
+     0x00, 0x00, 0xDA, 0xFA, 0x00, 0x00, 0x00, 0x00},
+    {0x8A, 0x9A, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+     0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00},
+    {0xE6, 0xE7, 0xDD, 0xEE, 0x9B, 0x9C, 0x00, 0x00,
+     0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xDE, 0x85},
+    {0xD0, 0xF0, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+     0x00, 0x00, 0xDB, 0xFB, 0x00, 0x00, 0x00, 0x00},
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+     0x9F, 0x00, 0x00, 0x00, 0x00, 0x8E, 0x9E, 0x00},
+    {0xEB, 0xFB, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+     0x00, 0x8D, 0xAB, 0xBD, 0xBE, 0xA6, 0xA7, 0x00},
+    {0x00, 0x00, 0xD8, 0xF8, 0x00, 0x00, 0x00, 0x00,
+     0x00, 0xCA, 0xEA, 0xDD, 0xFD, 0xDE, 0xFE, 0x00},
+    {0x00, 0x00, 0x9F, 0x00, 0x00, 0x00, 0x00, 0x00,
+     0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00},
+    {0x00, 0x00, 0x83, 0x00, 0x00, 0x00, 0x00, 0x00,
+     0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00},
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x88, 0x00,
+     0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00},
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xF3,
+     0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00},
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x8E,
+     0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00},
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+     0x00, 0x00, 0x00, 0x00, 0x98, 0x00, 0x00, 0x00},
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+     0xF4, 0xFA, 0x00, 0xF2, 0x00, 0xF1, 0x00, 0x00},
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+     0x00, 0xFF, 0x00, 0x9E, 0x00, 0x00, 0x00, 0x00},
+    {0x00, 0x00, 0x00, 0x00, 0xB4, 0xA1, 0xA2, 0x00,
+     0xB8, 0xB9, 0xBA, 0x00, 0xBC, 0x00, 0xBE, 0xBF},
+    {0x00, 0x00, 0x00, 0xE2, 0x00, 0x00, 0x00, 0x00,
+     0xE9, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00},
+    {0x00, 0x00, 0x00, 0xE4, 0x00, 0x00, 0xE8, 0x00,
+     0x00, 0xEA, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00},
+    {0xD0, 0xD1, 0x00, 0xD3, 0xD4, 0xD5, 0xD6, 0xD7,
+     0xD8, 0xD9, 0xDA, 0xDB, 0xDC, 0xDD, 0xDE, 0xDF},
+    {0x00, 0xE0, 0x00, 0x00, 0xEB, 0xEE, 0x00, 0x00,
+     0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00},
+    {0xE3, 0x00, 0x00, 0xE5, 0xE7, 0x00, 0xED, 0x00,
+     0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00},
+    {0xF0, 0xF1, 0xF2, 0xF3, 0xF4, 0xF5, 0xF6, 0xF7,
+     0xF8, 0xF9, 0xFA, 0xFB, 0xFC, 0xFD, 0xFE, 0x00},
+    {0x00, 0xF0, 0x00, 0x00, 0xF2, 0x00, 0x00, 0xF4,
+     0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xF6, 0x00},
+    {0x00, 0xA8, 0x80, 0x81, 0xAA, 0xBD, 0xB2, 0xAF,
+     0xA3, 0x8A, 0x8C, 0x8E, 0x8D, 0x00, 0xA1, 0x8F},
+    {0x80, 0x81, 0x82, 0x83, 0x84, 0x85, 0x86, 0x87,
+     0x88, 0x89, 0x8A, 0x8B, 0x8C, 0x8D, 0x8E, 0x8F},
+    {0x90, 0x91, 0x92, 0x93, 0x94, 0x95, 0x96, 0x97,
+     0x98, 0x99, 0x9A, 0x9B, 0x9C, 0x9D, 0x9E, 0x9F},
+    {0x00, 0xF1, 0x00, 0x00, 0xF3, 0x00, 0x00, 0xF5,
+     0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xF7, 0x00},
+    {0x00, 0xB8, 0x90, 0x83, 0xBA, 0xBE, 0xB3, 0xBF,
+     0xBC, 0x9A, 0x9C, 0x9E, 0x9D, 0x00, 0xA2, 0x9F},
+    {0xA5, 0xB4, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+     0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00},
+    {0x00, 0x00, 0x00, 0x96, 0x97, 0x00, 0x00, 0x00,
+     0x91, 0x92, 0x82, 0x00, 0x93, 0x94, 0x84, 0x00},
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xF2,
+     0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00},
+    {0x00, 0x00, 0x00, 0x96, 0x97, 0xAF, 0x00, 0x00,
+     0x91, 0x92, 0x82, 0x00, 0x93, 0x94, 0x84, 0x00},
+    {0x86, 0x87, 0x95, 0x00, 0x00, 0x00, 0x85, 0x00,
+     0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00},
+    {0x89, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+     0x00, 0x8B, 0x9B, 0x00, 0x00, 0x00, 0x00, 0x00},
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+     0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xFC},
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x9E,
+     0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00},
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+     0x00, 0x00, 0x00, 0x00, 0x80, 0x00, 0x00, 0x00},
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+     0x00, 0x00, 0x00, 0x00, 0xD5, 0x00, 0x00, 0x00},
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+     0x00, 0x00, 0x00, 0x00, 0x88, 0x00, 0x00, 0x00},
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xFC, 0x00,
+     0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00},
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xB9, 0x00,
+     0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00},
+    {0x00, 0x00, 0x99, 0x00, 0x00, 0x00, 0x00, 0x00,
+     0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00},
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+     0x00, 0xF9, 0xFB, 0x00, 0x00, 0x00, 0xEC, 0x00},
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+     0x00, 0xF9, 0xFB, 0x00, 0x00, 0x00, 0x00, 0x00},
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+     0x00, 0xEF, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00},
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+     0xF7, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00},
+    {0x00, 0xF0, 0x00, 0x00, 0xF3, 0xF2, 0x00, 0x00,
+     0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00},
+    {0xA9, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+     0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00},
+    {0xF4, 0xF5, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+     0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00},
+    {0xC4, 0x00, 0xB3, 0x00, 0x00, 0x00, 0x00, 0x00,
+     0x00, 0x00, 0x00, 0x00, 0xDA, 0x00, 0x00, 0x00},
+    {0xBF, 0x00, 0x00, 0x00, 0xC0, 0x00, 0x00, 0x00,
+     0xD9, 0x00, 0x00, 0x00, 0xC3, 0x00, 0x00, 0x00},
+    {0x00, 0x00, 0x00, 0x00, 0xB4, 0x00, 0x00, 0x00,
+     0x00, 0x00, 0x00, 0x00, 0xC2, 0x00, 0x00, 0x00},
+    {0x00, 0x00, 0x00, 0x00, 0xC1, 0x00, 0x00, 0x00,
+     0x00, 0x00, 0x00, 0x00, 0xC5, 0x00, 0x00, 0x00},
+    {0xCD, 0xBA, 0xD5, 0xD6, 0xC9, 0xB8, 0xB7, 0xBB,
+     0xD4, 0xD3, 0xC8, 0xBE, 0xBD, 0xBC, 0xC6, 0xC7},
+    {0xCD, 0xBA, 0x00, 0x00, 0xC9, 0x00, 0x00, 0xBB,
+     0x00, 0x00, 0xC8, 0x00, 0x00, 0xBC, 0x00, 0x00},
+    {0xCC, 0xB5, 0xB6, 0xB9, 0xD1, 0xD2, 0xCB, 0xCF,
+     0xD0, 0xCA, 0xD8, 0xD7, 0xCE, 0x00, 0x00, 0x00},
+    {0xCC, 0x00, 0x00, 0xB9, 0x00, 0x00, 0xCB, 0x00,
+     0x00, 0xCA, 0x00, 0x00, 0xCE, 0x00, 0x00, 0x00},
+    {0xDF, 0x00, 0x00, 0x00, 0xDC, 0x00, 0x00, 0x00,
+     0xDB, 0x00, 0x00, 0x00, 0xDD, 0x00, 0x00, 0x00},
+    {0xDF, 0x00, 0x00, 0x00, 0xDC, 0x00, 0x00, 0x00,
+     0xDB, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00},
+    {0xDE, 0xB0, 0xB1, 0xB2, 0x00, 0x00, 0x00, 0x00,
+     0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00},
+    {0x00, 0xB0, 0xB1, 0xB2, 0x00, 0x00, 0x00, 0x00,
+     0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00},
+    {0xFE, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+     0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00}};
+
+#endif // ADAFRUIT_THERMALCODEPAGES_H
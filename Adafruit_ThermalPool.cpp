@@ -0,0 +1,107 @@
+/*!
+ * @file Adafruit_ThermalPool.cpp
+ *
+ * Runs several printers from one cooperative loop.  Each member is an
+ * ordinary Adafruit_Thermal in asynchronous mode: its poll() already
+ * sends only what its own time budget allows and never waits, so polling
+ * every member in turn interleaves their output at full speed.  A member
+ * that is waiting for room in its job queue (or in drain()) polls the
+ * whole pool while it waits, so queueing a long job on one printer
+ * doesn't stall the others either.
+ */
+
+#include "Adafruit_ThermalPool.h"
+
+Adafruit_ThermalPool::Adafruit_ThermalPool() {
+  numPrinters = 0;
+  lastPick = 0;
+  polling = false;
+}
+
+bool Adafruit_ThermalPool::add(Adafruit_Thermal *p, uint8_t *buf,
+                               uint16_t size) {
+  if (!p || (numPrinters >= THERMAL_POOL_MAX))
+    return false;
+  p->beginAsync(buf, size);
+  if (!p->jobBuf)
+    return false;
+  p->pool = this;
+  printers[numPrinters++] = p;
+  lastPick = numPrinters - 1; // So the first pick is the first printer
+  return true;
+}
+
+// A printer reachable from a job callback can land back here through
+// jobReserve(); that inner call does nothing, and the outer loop carries
+// on when the callback returns.
+bool Adafruit_ThermalPool::poll() {
+  bool busy = false;
+  if (polling)
+    return true;
+  polling = true;
+  for (uint8_t i = 0; i < numPrinters; i++) {
+    if (printers[i]->poll())
+      busy = true;
+  }
+  polling = false;
+  return busy;
+}
+
+void Adafruit_ThermalPool::drain() {
+  while (poll()) {
+    yield();
+  }
+}
+
+// True unless the printer's cached status says it can't print.
+bool Adafruit_ThermalPool::available(uint8_t i) {
+  return !(printers[i]->statusFlags() &
+           (STATUS_PAPER_OUT | STATUS_COVER_OPEN | STATUS_OFFLINE));
+}
+
+Adafruit_Thermal *Adafruit_ThermalPool::next() {
+  uint8_t best = THERMAL_POOL_MAX;
+  bool bestUp = false;
+  unsigned long bestTime = 0;
+  uint16_t bestBytes = 0;
+
+  // Starting after the last pick makes equal loads take turns
+  for (uint8_t k = 1; k <= numPrinters; k++) {
+    uint8_t i = (lastPick + k) % numPrinters;
+    bool up = available(i);
+    unsigned long t = printers[i]->pendingTime();
+    uint16_t b = printers[i]->queuedBytes();
+    if ((best == THERMAL_POOL_MAX) || (up && !bestUp) ||
+        ((up == bestUp) &&
+         ((t < bestTime) || ((t == bestTime) && (b < bestBytes))))) {
+      best = i;
+      bestUp = up;
+      bestTime = t;
+      bestBytes = b;
+    }
+  }
+  if (best == THERMAL_POOL_MAX)
+    return NULL;
+  lastPick = best;
+  return printers[best];
+}
+
+Adafruit_Thermal *Adafruit_ThermalPool::nextInTurn() {
+  if (!numPrinters)
+    return NULL;
+  for (uint8_t k = 1; k <= numPrinters; k++) {
+    uint8_t i = (lastPick + k) % numPrinters;
+    if (available(i)) {
+      lastPick = i;
+      return printers[i];
+    }
+  }
+  lastPick = (lastPick + 1) % numPrinters; // None up; keep rotating
+  return printers[lastPick];
+}
+
+Adafruit_Thermal *Adafruit_ThermalPool::printer(uint8_t i) {
+  return (i < numPrinters) ? printers[i] : NULL;
+}
+
+uint8_t Adafruit_ThermalPool::count() { return numPrinters; }
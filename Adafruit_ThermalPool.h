@@ -0,0 +1,82 @@
+/*!
+ * @file Adafruit_ThermalPool.h
+ */
+
+#ifndef ADAFRUIT_THERMALPOOL_H
+#define ADAFRUIT_THERMALPOOL_H
+
+#include "Adafruit_Thermal.h"
+
+#ifndef THERMAL_POOL_MAX
+#define THERMAL_POOL_MAX 4 //!< Most printers one pool can drive
+#endif
+
+/*!
+ * Drives several printers from one loop.  Each printer runs in
+ * asynchronous mode with its own job queue, and the pool's poll() feeds
+ * all of them in turn, so a long job on one never holds up the others.
+ * next() picks the printer that will be free soonest for the next job.
+ * Queueing waits only when a printer's queue is full, so give each one
+ * room for a whole job and the jobs overlap completely.
+ */
+class Adafruit_ThermalPool {
+
+public:
+  /*!
+   * @brief Pool constructor
+   */
+  Adafruit_ThermalPool();
+
+  /*!
+   * @brief Adds a printer to the pool and switches it to asynchronous
+   *        mode.  Call begin() and wake() on the printer before this.
+   * @param p The printer
+   * @param buf Storage for the printer's job queue (at least 8 bytes)
+   * @param size Size of buf in bytes
+   * @return Returns false if the pool is full or buf is too small
+   */
+  bool add(Adafruit_Thermal *p, uint8_t *buf, uint16_t size);
+  /*!
+   * @brief Sends what each printer's time budget allows, without waiting
+   * @return Returns true while any printer has queued data
+   */
+  bool poll();
+  /*!
+   * @brief Picks the printer to send the next job to: the one expected
+   *        to finish its queued work soonest (see pendingTime()).  Ties
+   *        go round-robin, and printers reporting paper out, cover open
+   *        or offline are passed over while any other is available.
+   * @return Returns the printer, or NULL if the pool is empty
+   */
+  Adafruit_Thermal *next();
+  /*!
+   * @brief Picks printers in strict rotation, passing over any that
+   *        report paper out, cover open or offline
+   * @return Returns the printer, or NULL if the pool is empty
+   */
+  Adafruit_Thermal *nextInTurn();
+  /*!
+   * @brief Printer by position in the pool
+   * @param i Index, in the order the printers were added
+   * @return Returns the printer, or NULL if there is none at i
+   */
+  Adafruit_Thermal *printer(uint8_t i);
+  /*!
+   * @brief Number of printers in the pool
+   * @return Returns the count
+   */
+  uint8_t count();
+  /*!
+   * @brief Blocks until every printer's job queue has been sent
+   */
+  void drain();
+
+private:
+  Adafruit_Thermal *printers[THERMAL_POOL_MAX]; // Members of the pool
+  uint8_t numPrinters, // Printers in printers[]
+      lastPick;        // Index next() or nextInTurn() last returned
+  bool polling;        // True inside poll(), which job callbacks may reach
+  bool available(uint8_t i);
+};
+
+#endif // ADAFRUIT_THERMALPOOL_H
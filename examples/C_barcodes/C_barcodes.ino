@@ -89,6 +89,11 @@ void setup() {
   printer.print(F("CODE128:"));
   printer.printBarcode("Adafruit", CODE128);
 
+  // QR CODE: any text; drawn by the printer if it has GS ( k, else by
+  // the library (up to THERMAL_QR_VERSION_MAX)
+  printer.println(F("QR CODE:"));
+  printer.printQRCode("https://www.adafruit.com/product/597");
+
   printer.feed(2);
   printer.setDefault(); // Restore printer to defaults
 }
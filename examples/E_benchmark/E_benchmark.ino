@@ -0,0 +1,200 @@
+/*------------------------------------------------------------------------
+  Example sketch for Adafruit Thermal Printer library for Arduino.
+  Benchmarks the library without a printer attached.  A few typical jobs
+  (the text styles of A_printertest, barcodes, a bitmap, a QR code, UTF-8
+  text and a composed receipt line) are sent to a RecordingStream instead of a printer, and the
+  Serial monitor shows, for each one, the bytes sent, how many of them
+  were text, the number of commands and stream writes, and the time the
+  library expects the printer to take.  Run it before and after changing
+  the library to see what the change does.
+
+  The library paces its output by its estimate of the printer's speed,
+  so on a board each job runs about as long as it would take to print.
+  The host folder builds the same sketch for a desktop with a virtual
+  clock instead, so it runs in a moment with repeatable numbers: run
+  "make run" there.  Set BENCHMARK_FIRMWARE to compare firmware
+  (FIRMWARE_ESCPOS printers get raster bitmaps and native QR codes), and
+  build the library with THERMAL_STATS defined to see its wait counters.
+  ------------------------------------------------------------------------*/
+
+#include "Adafruit_Thermal.h"
+#include "RecordingStream.h"
+
+#ifndef BENCHMARK_FIRMWARE
+#define BENCHMARK_FIRMWARE 268 // Or e.g. FIRMWARE_ESCPOS
+#endif
+
+RecordingStream recorder;            // Counts what a printer would receive
+Adafruit_Thermal printer(&recorder); // Pass addr to printer constructor
+
+// A striped test image, made a byte at a time as it's read, so a full
+// width bitmap needs no RAM or flash for its pixels
+class PatternStream : public Stream {
+public:
+  void start(uint16_t rowBytes, uint16_t rows) {
+    width = rowBytes;
+    left = (uint32_t)rowBytes * rows;
+    pos = 0;
+  }
+  int available() { return (left > 32767) ? 32767 : left; }
+  int read() {
+    if (!left)
+      return -1;
+    int b = peek();
+    left--;
+    pos++;
+    return b;
+  }
+  int peek() {
+    if (!left)
+      return -1;
+    uint16_t x = pos % width, y = pos / width;
+    return ((x + y / 8) & 1) ? 0xFF : 0x00;
+  }
+  size_t write(uint8_t) { return 0; }
+
+private:
+  uint16_t width; // Bytes per row
+  uint32_t left,  // Bytes still to be read
+      pos;        // Bytes read so far
+} pattern;
+
+void textJob() {
+  printer.setFont('B');
+  printer.println(F("FontB"));
+  printer.println(F("ABCDEFGHIJKLMNOPQRSTUVWXYZ"));
+  printer.setFont('A');
+  printer.println(F("FontA (default)"));
+  printer.println(F("ABCDEFGHIJKLMNOPQRSTUVWXYZ"));
+  printer.inverseOn();
+  printer.println(F("Inverse ON"));
+  printer.inverseOff();
+  printer.doubleHeightOn();
+  printer.println(F("Double Height ON"));
+  printer.doubleHeightOff();
+  printer.justify('R');
+  printer.println(F("Right justified"));
+  printer.justify('C');
+  printer.println(F("Center justified"));
+  printer.justify('L');
+  printer.println(F("Left justified"));
+  printer.boldOn();
+  printer.println(F("Bold text"));
+  printer.boldOff();
+  printer.underlineOn();
+  printer.println(F("Underlined text"));
+  printer.underlineOff();
+  printer.setSize('L');
+  printer.println(F("Large"));
+  printer.setSize('M');
+  printer.println(F("Medium"));
+  printer.setSize('S');
+  printer.println(F("Small"));
+  printer.justify('C');
+  printer.println(F("normal\nline\nspacing"));
+  printer.setLineHeight(50);
+  printer.println(F("Taller\nline\nspacing"));
+  printer.setLineHeight();
+  printer.justify('L');
+  printer.feed(2);
+}
+
+void barcodeJob() {
+  printer.printBarcode("ADAFRUT", CODE39);
+  printer.setBarcodeHeight(100);
+  printer.printBarcode("123456789123", UPC_A);
+  printer.printBarcode("1234567890123", EAN13);
+  printer.printBarcode("Adafruit", CODE128);
+  printer.setBarcodeHeight();
+  printer.feed(2);
+}
+
+void bitmapJob() {
+  pattern.start(48, 200); // 384 x 200 pixels
+  printer.printBitmap(384, 200, &pattern);
+  printer.feed(2);
+}
+
+void qrJob() {
+  printer.printQRCode("https://www.adafruit.com/");
+  printer.feed(2);
+}
+
+void utf8Job() {
+  printer.printUTF8("Café crème brûlée €4.50\n");
+  printer.printUTF8("Привет, Καλημέρα\n");
+  printer.printUTF8("Łódź ── Żółw\n");
+  printer.feed(2);
+}
+
+// Records a receipt line with deferred styles, so the bold around the
+// field is only sent when composeField() flushes it, then fills it in
+void composeJob() {
+  static uint8_t receipt[64];
+  static const char *const totals[] = {"$9.99", "$12.50", "$0.75"};
+  printer.deferStyleOn();
+  printer.beginCompose(receipt, sizeof receipt);
+  printer.print(F("Total: "));
+  printer.boldOn();
+  printer.composeField(0);
+  printer.boldOff();
+  printer.println();
+  uint16_t len = printer.endCompose();
+  printer.deferStyleOff();
+  for (uint8_t i = 0; i < 3; i++)
+    printer.printComposed(receipt, len, &totals[i], 1);
+  printer.feed(2);
+}
+
+// Runs one job and prints a row of the table.  The time is what the job
+// took to send (the library waits whenever the printer would be busy)
+// plus what it expects the printer still to need when it returns.
+void run(const __FlashStringHelper *name, void (*job)()) {
+  printer.timeoutWait(); // Start with the printer idle
+  recorder.clear();
+#ifdef THERMAL_STATS
+  printer.getStats(); // Clear the counters
+#endif
+  unsigned long start = micros();
+  job();
+  unsigned long t = micros() - start + printer.pendingTime();
+  Serial.print(name);
+  Serial.print('\t');
+  Serial.print(recorder.bytes);
+  Serial.print('\t');
+  Serial.print(recorder.textBytes);
+  Serial.print('\t');
+  Serial.print(recorder.commands);
+  Serial.print('\t');
+  Serial.print(recorder.writes);
+  Serial.print('\t');
+  Serial.print(t / 1000);
+#ifdef THERMAL_STATS
+  ThermalStats s = printer.getStats();
+  Serial.print('\t');
+  Serial.print(s.waits);
+  Serial.print('\t');
+  Serial.print(s.waitMicros / 1000);
+#endif
+  Serial.println();
+}
+
+void setup() {
+  Serial.begin(9600);
+  printer.begin(BENCHMARK_FIRMWARE);
+
+  Serial.print(F("job\tbytes\ttext\tcmds\twrites\tms"));
+#ifdef THERMAL_STATS
+  Serial.print(F("\twaits\twait ms"));
+#endif
+  Serial.println();
+  run(F("text"), textJob);
+  run(F("barcode"), barcodeJob);
+  run(F("bitmap"), bitmapJob);
+  run(F("qrcode"), qrJob);
+  run(F("utf8"), utf8Job);
+  run(F("compose"), composeJob);
+}
+
+void loop() {
+}
@@ -0,0 +1,169 @@
+#ifndef _RecordingStream_h_
+#define _RecordingStream_h_
+
+// A Stream that stands in for the printer.  Nothing is printed: each byte
+// the library sends is counted and parsed just far enough to tell printed
+// text from commands and their data, and status requests (DLE EOT) get
+// the reply of a printer that is online with paper loaded.  Only the
+// commands Adafruit_Thermal sends are known; any other byte after ESC, GS,
+// DC2, FS or DLE counts as a command with no arguments.
+
+#include "Arduino.h"
+
+class RecordingStream : public Stream {
+public:
+  uint32_t bytes, // Everything sent
+      textBytes,  // Printable text and line feeds
+      commands,   // Command frames
+      writes;     // Calls to write(), single bytes or blocks
+
+  RecordingStream() {
+    state = TEXT;
+    glyphs = replies = 0;
+    skip = 0;
+    clear();
+  }
+
+  // Zeroes the counters; a command that is half through stays parsed
+  void clear() { bytes = textBytes = commands = writes = 0; }
+
+  size_t write(uint8_t b) {
+    writes++;
+    take(b);
+    return 1;
+  }
+
+  size_t write(const uint8_t *buf, size_t n) {
+    writes++;
+    for (size_t i = 0; i < n; i++)
+      take(buf[i]);
+    return n;
+  }
+
+  int available() { return replies; }
+  int read() {
+    if (!replies)
+      return -1;
+    replies--;
+    return 0x12; // Online, paper present, cover closed
+  }
+  int peek() { return replies ? 0x12 : -1; }
+  void flush() {}
+
+private:
+  enum {
+    TEXT,     // Between commands
+    FUNCTION, // Got the lead byte, waiting for the function byte
+    ARGS,     // Collecting need more argument bytes into args[]
+    SKIP,     // Passing over skip bytes of command data
+    TO_NUL,   // Passing over data up to a NUL
+    GLYPH     // At the width byte of the next ESC & glyph
+  };
+  uint8_t state, lead, fn, args[6], argLen, need, glyphs, replies;
+  uint32_t skip; // Data bytes left in SKIP state
+
+  void take(uint8_t b) {
+    bytes++;
+    switch (state) {
+    case TEXT:
+      if ((b == 0x1B) || (b == 0x1D) || (b == 0x12) || (b == 0x1C) ||
+          (b == 0x10)) {
+        lead = b;
+        commands++;
+        state = FUNCTION;
+      } else if ((b >= ' ') || (b == '\n') || (b == '\t')) {
+        textBytes++;
+      }
+      break;
+    case FUNCTION:
+      fn = b;
+      argLen = 0;
+      need = argCount();
+      state = need ? ARGS : TEXT;
+      if (!need)
+        finish();
+      break;
+    case ARGS:
+      args[argLen++] = b;
+      if (!--need) {
+        state = TEXT;
+        finish();
+      }
+      break;
+    case SKIP:
+      if (!--skip)
+        state = glyphs ? GLYPH : TEXT;
+      break;
+    case TO_NUL:
+      if (!b)
+        state = TEXT;
+      break;
+    case GLYPH:
+      glyphs--;
+      skip = (uint32_t)args[0] * b;
+      state = skip ? SKIP : glyphs ? GLYPH : TEXT;
+      break;
+    }
+  }
+
+  // Argument bytes that follow the function byte
+  uint8_t argCount() {
+    switch (lead) {
+    case 0x1B: // ESC
+      if ((fn == '@') || (fn == 'D'))
+        return 0;
+      if (fn == '8')
+        return 2;
+      if ((fn == '7') || (fn == '&'))
+        return 3;
+      return 1;
+    case 0x1D: // GS
+      if (fn == '(')
+        return 3;
+      if (fn == 'v')
+        return 6;
+      return 1;
+    case 0x12: // DC2
+      if (fn == '*')
+        return 2;
+      return (fn == '#') ? 1 : 0;
+    case 0x10: // DLE
+      return (fn == 4) ? 1 : 0;
+    }
+    return 0; // FS and anything unknown
+  }
+
+  // Sets up whatever follows the arguments just collected
+  void finish() {
+    if ((lead == 0x1B) && (fn == 'D')) {
+      state = TO_NUL; // Tab stops
+    } else if ((lead == 0x1B) && (fn == '&')) {
+      glyphs = args[2] - args[1] + 1; // y c1 c2, then each glyph
+      state = GLYPH;
+    } else if ((lead == 0x1D) && (fn == 'k')) {
+      if (args[0] >= 65) {
+        if (argLen == 1) {
+          need = 1; // Length byte comes next
+          state = ARGS;
+        } else if ((skip = args[1])) {
+          state = SKIP;
+        }
+      } else {
+        state = TO_NUL;
+      }
+    } else if ((lead == 0x1D) && (fn == '(')) {
+      skip = args[1] | ((uint16_t)args[2] << 8); // k pL pH
+    } else if ((lead == 0x1D) && (fn == 'v')) {
+      skip = (uint32_t)(args[2] | (args[3] << 8)) *
+             (args[4] | (args[5] << 8)); // '0' m xL xH yL yH
+    } else if ((lead == 0x12) && (fn == '*')) {
+      skip = (uint32_t)args[0] * args[1];
+    } else if (lead == 0x10) {
+      replies++; // DLE EOT n
+    }
+    if ((state == TEXT) && skip)
+      state = SKIP;
+  }
+};
+
+#endif // _RecordingStream_h_
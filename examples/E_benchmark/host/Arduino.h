@@ -0,0 +1,134 @@
+#ifndef _Arduino_h_
+#define _Arduino_h_
+
+// Just enough of the Arduino core to build Adafruit_Thermal and the
+// E_benchmark sketch on a desktop.  Time is virtual: micros() only moves
+// when the code waits (delay(), delayMicroseconds() or a yield() in a
+// busy loop), so a job that would keep a printer busy for a minute runs
+// in a moment, and every run gives the same numbers.
+
+#include <ctype.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+typedef bool boolean;
+typedef uint8_t byte;
+
+#define HIGH 1
+#define LOW 0
+#define INPUT 0
+#define OUTPUT 1
+#define INPUT_PULLUP 2
+
+// Flash is ordinary memory here
+#define PROGMEM
+#define PGM_P const char *
+#define pgm_read_byte(p) (*(const uint8_t *)(p))
+#define pgm_read_word(p) (*(const uint16_t *)(p))
+#define pgm_read_dword(p) (*(const uint32_t *)(p))
+#define memcpy_P memcpy
+#define strlen_P strlen
+
+class __FlashStringHelper;
+#define F(s) (reinterpret_cast<const __FlashStringHelper *>(s))
+
+// Virtual clock, in microseconds
+extern unsigned long hostMicros;
+inline unsigned long micros() { return hostMicros; }
+inline unsigned long millis() { return hostMicros / 1000; }
+inline void delay(unsigned long ms) { hostMicros += ms * 1000; }
+inline void delayMicroseconds(unsigned int us) { hostMicros += us; }
+inline void yield() { hostMicros++; } // Busy loops move time along
+
+// No pins: DTR reads as ready
+inline void pinMode(uint8_t, uint8_t) {}
+inline void digitalWrite(uint8_t, uint8_t) {}
+inline int digitalRead(uint8_t) { return LOW; }
+
+class Print {
+public:
+  virtual ~Print() {}
+  virtual size_t write(uint8_t b) = 0;
+  virtual size_t write(const uint8_t *buf, size_t n) {
+    size_t sent = 0;
+    while (n--)
+      sent += write(*buf++);
+    return sent;
+  }
+  size_t write(const char *s) { return write((const uint8_t *)s, strlen(s)); }
+  virtual int availableForWrite() { return 0; }
+  virtual void flush() {}
+
+  size_t print(const char *s) { return write(s); }
+  size_t print(const __FlashStringHelper *s) { return print((PGM_P)s); }
+  size_t print(char c) { return write((uint8_t)c); }
+  size_t print(int n) { return print((long)n); }
+  size_t print(unsigned int n) { return print((unsigned long)n); }
+  size_t print(long n) {
+    char buf[24];
+    snprintf(buf, sizeof buf, "%ld", n);
+    return write(buf);
+  }
+  size_t print(unsigned long n) {
+    char buf[24];
+    snprintf(buf, sizeof buf, "%lu", n);
+    return write(buf);
+  }
+  size_t println() { return write("\r\n"); }
+  template <class T> size_t println(T x) { return print(x) + println(); }
+};
+
+class Stream : public Print {
+public:
+  Stream() : timeout(1000) {}
+  virtual int available() = 0;
+  virtual int read() = 0;
+  virtual int peek() = 0;
+  void setTimeout(unsigned long ms) { timeout = ms; }
+  size_t readBytes(uint8_t *buf, size_t n) {
+    size_t got = 0;
+    while (got < n) {
+      int c = timedRead();
+      if (c < 0)
+        break;
+      buf[got++] = c;
+    }
+    return got;
+  }
+  size_t readBytes(char *buf, size_t n) {
+    return readBytes((uint8_t *)buf, n);
+  }
+
+protected:
+  unsigned long timeout; // readBytes() gives up after this many ms
+
+  int timedRead() {
+    unsigned long start = millis();
+    do {
+      int c = read();
+      if (c >= 0)
+        return c;
+      yield();
+    } while (millis() - start < timeout);
+    return -1;
+  }
+};
+
+// The serial monitor is standard output
+class HostSerial : public Stream {
+public:
+  void begin(unsigned long) {}
+  size_t write(uint8_t b) {
+    putchar(b);
+    return 1;
+  }
+  int available() { return 0; }
+  int read() { return -1; }
+  int peek() { return -1; }
+};
+extern HostSerial Serial;
+
+#endif // _Arduino_h_
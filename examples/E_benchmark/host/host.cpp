@@ -0,0 +1,14 @@
+// Runs the E_benchmark sketch on a desktop, against the Arduino stand-in
+// in this folder.  See the Makefile.
+
+#include "Arduino.h"
+
+unsigned long hostMicros = 0;
+HostSerial Serial;
+
+#include "../E_benchmark.ino"
+
+int main() {
+  setup();
+  return 0;
+}
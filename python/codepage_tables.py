@@ -0,0 +1,117 @@
+#!/usr/bin/env python
+#
+# This Python script writes Adafruit_ThermalCodePages.h, the Unicode to
+# code page lookup tables behind printUTF8().  Each code page's upper
+# half is read from Python's own codecs.  Run it from the library folder
+# after changing PAGES.
+#
+# The tables map a code point to a byte in each page in four steps, each
+# a single array lookup: the code point's top bits pick a row, its next
+# four bits pick one of the row's 16-code-point blocks, and the block and
+# page pick a 16-byte slice of bytes.  Slices are shared, so identical
+# runs (most of them empty) are stored once.
+#
+
+import codecs
+
+# (Python codec, CODEPAGE_* name from Adafruit_Thermal.h); at most 8
+PAGES = [
+    ('cp437', 'CODEPAGE_CP437'),
+    ('cp1252', 'CODEPAGE_WCP1252'),
+    ('cp858', 'CODEPAGE_CP858'),
+    ('cp852', 'CODEPAGE_CP852'),
+    ('cp866', 'CODEPAGE_CP866'),
+    ('cp1251', 'CODEPAGE_WCP1251'),
+    ('cp1253', 'CODEPAGE_WCP1253'),
+    ('cp1257', 'CODEPAGE_WCP1257'),
+]
+OUT_FILE = 'Adafruit_ThermalCodePages.h'
+
+rev = []
+for codec, _ in PAGES:
+    codecs.lookup(codec)
+    table = {}
+    for b in range(128, 256):
+        try:
+            u = ord(bytes([b]).decode(codec))
+        except UnicodeDecodeError:
+            continue
+        if u >= 0x80 and u not in table:
+            table[u] = b
+    rev.append(table)
+
+limit = max(max(t) for t in rev) + 1
+row_count = (limit + 255) >> 8
+rows = []       # u >> 8 -> row number + 1 (0: nothing mapped)
+row_blocks = []  # Per row, u >> 4 & 15 -> block number + 1
+blocks = []      # Per block, page -> slice number
+slices = [tuple([0] * 16)]
+slice_ids = {slices[0]: 0}
+for r in range(row_count):
+    used = False
+    entry = []
+    for k in range(16):
+        base = (r << 8) | (k << 4)
+        cells = [tuple(t.get(base + i, 0) for i in range(16)) for t in rev]
+        if not any(any(c) for c in cells):
+            entry.append(0)
+            continue
+        used = True
+        refs = []
+        for c in cells:
+            if c not in slice_ids:
+                slice_ids[c] = len(slices)
+                slices.append(c)
+            refs.append(slice_ids[c])
+        blocks.append(refs)
+        entry.append(len(blocks))
+    if used:
+        row_blocks.append(entry)
+        rows.append(len(row_blocks))
+    else:
+        rows.append(0)
+assert len(blocks) < 256 and len(slices) < 256 and len(PAGES) <= 8
+
+
+def rows_of(values, per_line):
+    return ',\n'.join('    ' + ', '.join(values[i:i + per_line])
+                      for i in range(0, len(values), per_line))
+
+
+with open(OUT_FILE, 'w') as f:
+    f.write('// Generated by python/codepage_tables.py; do not edit.\n')
+    f.write('// Unicode to code page tables for printUTF8(), in PROGMEM.\n\n')
+    f.write('#ifndef ADAFRUIT_THERMALCODEPAGES_H\n')
+    f.write('#define ADAFRUIT_THERMALCODEPAGES_H\n\n')
+    f.write('#define UTF8_PAGES %d //!< Code pages in the tables\n' %
+            len(PAGES))
+    f.write('#define UTF8_LIMIT 0x%04X //!< First code point past the '
+            'tables\n\n' % (row_count << 8))
+    f.write('// ESC t number of each page\n')
+    f.write('static const uint8_t PROGMEM utf8PageCodes[UTF8_PAGES] = {\n')
+    f.write(rows_of([n for _, n in PAGES], 3) + '};\n\n')
+    f.write('// Code point >> 8 -> row number + 1, or 0 if none\n')
+    f.write('static const uint8_t PROGMEM utf8Rows[%d] = {\n' % len(rows))
+    f.write(rows_of([str(v) for v in rows], 16) + '};\n\n')
+    f.write('// Row, then code point >> 4 & 15 -> block number + 1, or 0\n')
+    f.write('static const uint8_t PROGMEM utf8RowBlocks[%d][16] = {\n' %
+            len(row_blocks))
+    f.write(',\n'.join('    {' + ', '.join(str(v) for v in e) + '}'
+                       for e in row_blocks) + '};\n\n')
+    f.write('// Block, then page -> slice of 16 bytes (0 = not in page)\n')
+    f.write('static const uint8_t PROGMEM utf8Blocks[%d][UTF8_PAGES] = {\n' %
+            len(blocks))
+    f.write(',\n'.join('    {' + ', '.join(str(v) for v in b) + '}'
+                       for b in blocks) + '};\n\n')
+    f.write('// Slice, then code point & 15 -> byte in the page, or 0\n')
+    f.write('static const uint8_t PROGMEM utf8Slices[%d][16] = {\n' %
+            len(slices))
+    f.write(',\n'.join('    {' + ', '.join('0x%02X' % v for v in s[:8]) +
+                       ',\n     ' + ', '.join('0x%02X' % v for v in s[8:]) +
+                       '}' for s in slices) + '};\n\n')
+    f.write('#endif // ADAFRUIT_THERMALCODEPAGES_H\n')
+
+size = len(rows) + 16 * len(row_blocks) + len(PAGES) * len(blocks) + \
+    16 * len(slices) + len(PAGES)
+print('%s: %d pages, %d blocks, %d slices, %d bytes' %
+      (OUT_FILE, len(PAGES), len(blocks), len(slices), size))
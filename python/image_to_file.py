@@ -2,6 +2,8 @@
 #
 # This Pythons script uses PIL/Pillow to read in an image file
 # and convert it to a header file for use with printBitmap().
+# With --compress the data is written in the compressed format used
+# by printBitmapCompressed() instead.
 #
 
 import math
@@ -13,12 +15,42 @@ parser = argparse.ArgumentParser(description='Convert image to header file.')
 parser.add_argument('input_image', help='the input image file')
 parser.add_argument('-o', '--out_name', help='output name')
 parser.add_argument('-d', '--dither', help='dither image')
+parser.add_argument('-c', '--compress', action='store_true',
+                    help='compress for use with printBitmapCompressed()')
 args = parser.parse_args()
 
 IN_FILE = args.input_image
 NAME = args.out_name if args.out_name else IN_FILE.split('.')[0]
 DITHER = Image.FLOYDSTEINBERG if args.dither else Image.NONE
 
+def packbits(data):
+    """PackBits encode: n<128 is n+1 literals, n>128 repeats the next byte."""
+    out = bytearray()
+    i = 0
+    while i < len(data):
+        run = 1
+        while i + run < len(data) and run < 128 and data[i + run] == data[i]:
+            run += 1
+        if run >= 3:
+            out += bytes([257 - run, data[i]])
+            i += run
+            continue
+        j = i
+        while j < len(data) and j - i < 128 and not (
+                j + 2 < len(data) and data[j] == data[j + 1] == data[j + 2]):
+            j += 1
+        out.append(j - i - 1)
+        out += data[i:j]
+        i = j
+    return out
+
+def compress(data, row_bytes):
+    """XOR each row with the one above it, then PackBits the result."""
+    delta = bytearray(data)
+    for i in range(len(data) - 1, row_bytes - 1, -1):
+        delta[i] ^= data[i - row_bytes]
+    return packbits(delta)
+
 # open image file
 print("Reading input file", IN_FILE)
 img = Image.open(IN_FILE).convert('1', dither=DITHER)
@@ -37,6 +69,11 @@ for y in range(img.height):
             byte |= p << (7-shift)
         img_bytes.append(byte)
 
+if args.compress:
+    raw_size = len(img_bytes)
+    img_bytes = compress(img_bytes, CHUNKS)
+    print("Compressed {} bytes to {}.".format(raw_size, len(img_bytes)))
+
 # write header file
 header_file = NAME+'.h'
 print("Writing header file", header_file)
@@ -44,7 +81,12 @@ with open(header_file, 'w') as fp:
     fp.write("#ifndef _{}_h_\n".format(NAME))
     fp.write("#define _{}_h_\n\n".format(NAME))
     fp.write("#define {}_width {}\n".format(NAME, img.width))
-    fp.write("#define {}_height {}\n\n".format(NAME, img.height))
+    fp.write("#define {}_height {}\n".format(NAME, img.height))
+    if args.compress:
+        fp.write("#define {}_compressed 1 "
+                 "// Use printBitmapCompressed(), with sizeof {}_data\n"
+                 .format(NAME, NAME))
+    fp.write("\n")
     fp.write("static const uint8_t PROGMEM {}_data[] = ".format(NAME))
     fp.write("{\n")
     row_count = 0